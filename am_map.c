@@ -1003,61 +1003,94 @@ void AM_drawGrid(int color)
 }
 
 //
-// Determines visible lines, draws them.
-// This is LineDef based, not LineSeg based.
+// Draws one line, if it has been seen.
 //
-void AM_drawWalls(void)
+boolean AM_drawWall(line_t *line)
 {
-	int i;
 	static mline_t l;
 
-	for (i = 0; i < numlines; i++)
+	l.a.x = line->v1->x;
+	l.a.y = line->v1->y;
+	l.b.x = line->v2->x;
+	l.b.y = line->v2->y;
+	if (cheating || (line->flags & ML_MAPPED))
 	{
-		l.a.x = lines[i].v1->x;
-		l.a.y = lines[i].v1->y;
-		l.b.x = lines[i].v2->x;
-		l.b.y = lines[i].v2->y;
-		if (cheating || (lines[i].flags & ML_MAPPED))
+		if ((line->flags & LINE_NEVERSEE) && !cheating)
+			return true;
+		if (!line->backsector)
+		{
+			AM_drawMline(&l, WALLCOLORS + lightlev);
+		}
+		else
 		{
-			if ((lines[i].flags & LINE_NEVERSEE) && !cheating)
-				continue;
-			if (!lines[i].backsector)
+			if (line->special == 39)
+			{ // teleporters
+				AM_drawMline(&l, WALLCOLORS + WALLRANGE / 2);
+			}
+			else if (line->flags & ML_SECRET) // secret door
 			{
-				AM_drawMline(&l, WALLCOLORS + lightlev);
+				if (cheating)
+					AM_drawMline(&l, SECRETWALLCOLORS + lightlev);
+				else
+					AM_drawMline(&l, WALLCOLORS + lightlev);
 			}
-			else
+			else if (line->backsector->floorheight != line->frontsector->floorheight)
 			{
-				if (lines[i].special == 39)
-				{ // teleporters
-					AM_drawMline(&l, WALLCOLORS + WALLRANGE / 2);
-				}
-				else if (lines[i].flags & ML_SECRET) // secret door
-				{
-					if (cheating)
-						AM_drawMline(&l, SECRETWALLCOLORS + lightlev);
-					else
-						AM_drawMline(&l, WALLCOLORS + lightlev);
-				}
-				else if (lines[i].backsector->floorheight != lines[i].frontsector->floorheight)
-				{
-					AM_drawMline(&l, FDWALLCOLORS + lightlev); // floor level change
-				}
-				else if (lines[i].backsector->ceilingheight != lines[i].frontsector->ceilingheight)
-				{
-					AM_drawMline(&l, CDWALLCOLORS + lightlev); // ceiling level change
-				}
-				else if (cheating)
-				{
-					AM_drawMline(&l, TSWALLCOLORS + lightlev);
-				}
+				AM_drawMline(&l, FDWALLCOLORS + lightlev); // floor level change
+			}
+			else if (line->backsector->ceilingheight != line->frontsector->ceilingheight)
+			{
+				AM_drawMline(&l, CDWALLCOLORS + lightlev); // ceiling level change
+			}
+			else if (cheating)
+			{
+				AM_drawMline(&l, TSWALLCOLORS + lightlev);
 			}
 		}
-		else if (plr->powers[pw_allmap])
-		{
-			if (!(lines[i].flags & LINE_NEVERSEE))
-				AM_drawMline(&l, GRAYS + 3);
-		}
 	}
+	else if (plr->powers[pw_allmap])
+	{
+		if (!(line->flags & LINE_NEVERSEE))
+			AM_drawMline(&l, GRAYS + 3);
+	}
+
+	return true;
+}
+
+//
+// Determines visible lines, draws them.
+// This is LineDef based, not LineSeg based.
+// Only the lines in the blockmap cells under the
+//  map window are looked at.
+//
+void AM_drawWalls(void)
+{
+	int bx;
+	int by;
+	int bx1;
+	int by1;
+	int bx2;
+	int by2;
+
+	bx1 = (m_x - bmaporgx) >> MAPBLOCKSHIFT;
+	by1 = (m_y - bmaporgy) >> MAPBLOCKSHIFT;
+	bx2 = (m_x2 - bmaporgx) >> MAPBLOCKSHIFT;
+	by2 = (m_y2 - bmaporgy) >> MAPBLOCKSHIFT;
+
+	if (bx1 < 0)
+		bx1 = 0;
+	if (by1 < 0)
+		by1 = 0;
+	if (bx2 >= bmapwidth)
+		bx2 = bmapwidth - 1;
+	if (by2 >= bmapheight)
+		by2 = bmapheight - 1;
+
+	validcount++;
+
+	for (by = by1; by <= by2; by++)
+		for (bx = bx1; bx <= bx2; bx++)
+			P_BlockLinesIterator(bx, by, AM_drawWall);
 }
 
 //
@@ -20,6 +20,7 @@
 //
 
 #include <stdlib.h>
+#include <time.h>
 #include <dos.h>
 #include <direct.h>
 #include <io.h>
@@ -95,6 +96,12 @@ boolean monoSound;
 boolean lowSound;
 boolean waitInit;
 boolean noMelt;
+boolean prelitTextures;
+boolean tiledFlats;
+boolean usePVS;
+boolean linearView;
+boolean wadImage;
+boolean showTimings;
 
 boolean reverseStereo;
 
@@ -236,7 +243,9 @@ void D_Display(void)
         if (automapactive)
         {
             // [crispy] update automap while playing
-            R_RenderPlayerView(&players);
+            // The map covers the whole view, so only the
+            //  lines seen have to be worked out.
+            R_MarkMappedLines(&players);
             AM_Drawer();
         }
         if (wipe || (viewheight != 200 && fullscreen))
@@ -618,6 +627,102 @@ void D_AddFile(char *file)
     wadfiles[numwadfiles] = newfile;
 }
 
+//
+// TIMINGS
+// With -timings, the stages of the startup and of
+//  level loading note how long they took.
+//
+#define MAXTIMINGS 32
+#define TIMINGSLOG "timings.txt"
+
+char *timingname[MAXTIMINGS];
+int timingclocks[MAXTIMINGS];
+int numtimings;
+clock_t lasttiming;
+
+//
+// D_StartTimings
+//
+void D_StartTimings(void)
+{
+    numtimings = 0;
+    lasttiming = clock();
+}
+
+//
+// D_Timing
+// Notes the time since the last stage.
+//
+void D_Timing(char *name)
+{
+    clock_t now;
+
+    if (!showTimings)
+        return;
+
+    now = clock();
+
+    if (numtimings < MAXTIMINGS)
+    {
+        timingname[numtimings] = name;
+        timingclocks[numtimings] = now - lasttiming;
+        numtimings++;
+    }
+
+    lasttiming = now;
+}
+
+//
+// D_WriteTimings
+//
+void D_WriteTimings(FILE *f)
+{
+    int i;
+    int total;
+
+    total = 0;
+
+    for (i = 0; i < numtimings; i++)
+    {
+        fprintf(f, "%-24s %6i ms\n", timingname[i], timingclocks[i] * 1000 / CLOCKS_PER_SEC);
+        total += timingclocks[i];
+    }
+
+    fprintf(f, "%-24s %6i ms\n", "Total", total * 1000 / CLOCKS_PER_SEC);
+}
+
+//
+// D_PrintTimings
+//
+void D_PrintTimings(void)
+{
+    if (showTimings)
+        D_WriteTimings(stdout);
+}
+
+//
+// D_LogTimings
+// The game screen hides stdout, so timings taken
+//  while playing are added to TIMINGSLOG instead.
+//
+void D_LogTimings(char *title)
+{
+    FILE *f;
+
+    if (!showTimings)
+        return;
+
+    f = fopen(TIMINGSLOG, "a");
+
+    if (!f)
+        return;
+
+    fprintf(f, "%s\n", title);
+    D_WriteTimings(f);
+    fprintf(f, "\n");
+    fclose(f);
+}
+
 //
 // IdentifyVersion
 // Checks availability of IWAD files by name,
@@ -785,6 +890,13 @@ void D_DoomMain(void)
 
     noMelt = M_CheckParm("-nomelt");
 
+    prelitTextures = M_CheckParm("-prelit");
+    tiledFlats = M_CheckParm("-tiledflats");
+    usePVS = M_CheckParm("-pvs");
+    linearView = M_CheckParm("-linear");
+    wadImage = M_CheckParm("-wadimage");
+    showTimings = M_CheckParm("-timings");
+
     singletics = M_CheckParm("-singletics");
 
     uncappedFPS = M_CheckParm("-uncapped");
@@ -793,6 +905,14 @@ void D_DoomMain(void)
 
     logTimedemo = M_CheckParm("-logTimedemo");
 
+    if ((p = M_CheckParm("-zonereserve")))
+    {
+        if (p < myargc - 1)
+            zonereserve = atoi(myargv[p + 1]);
+        if (zonereserve < 0)
+            zonereserve = 0;
+    }
+
     if ((p = M_CheckParm("-size")))
     {
         if (p < myargc - 1)
@@ -944,12 +1064,15 @@ void D_DoomMain(void)
     printf("M_LoadDefaults: Load system defaults.\n");
     M_LoadDefaults(); // load before initing other systems
 
-    printf("Z_Init: Init zone memory allocation daemon. \n");
-    Z_Init();
-
+    // before the zone, which can take all the memory with -ram
     printf("W_Init: Init WADfiles.\n");
+    D_StartTimings();
     W_InitMultipleFiles(wadfiles);
 
+    printf("Z_Init: Init zone memory allocation daemon. \n");
+    Z_Init();
+    D_Timing("Z_Init");
+
     // Check for -file in shareware
     if (modifiedgame)
     {
@@ -1019,14 +1142,17 @@ void D_DoomMain(void)
     printf("M_Init: Init miscellaneous info.\n");
     D_RedrawTitle();
     M_Init();
+    D_Timing("M_Init");
 
     printf("R_Init: Init DOOM refresh daemon - ");
     D_RedrawTitle();
     R_Init();
+    D_Timing("R_Init");
 
     printf("\nP_Init: Init Playloop state.\n");
     D_RedrawTitle();
     P_Init();
+    D_PrintTimings();
 
     printf("I_Init: Setting up machine state.\n");
     D_RedrawTitle();
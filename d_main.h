@@ -26,6 +26,14 @@ extern char *wadfiles[MAXWADFILES];
 
 void D_AddFile(char *file);
 
+// With -timings, D_Timing notes how long the stage that
+//  just finished took, D_PrintTimings lists them and
+//  D_LogTimings adds them to a log file.
+void D_StartTimings(void);
+void D_Timing(char *name);
+void D_PrintTimings(void);
+void D_LogTimings(char *title);
+
 //
 // D_DoomMain()
 // Not a globally visible function, just included for source reference,
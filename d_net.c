@@ -23,6 +23,7 @@
 #include "doomdef.h"
 #include "doomstat.h"
 #include "d_main.h"
+#include "w_wad.h"
 
 doomcom_t *doomcom;
 doomdata_t *netbuffer; // points inside doomcom
@@ -193,6 +194,9 @@ void TryRunTics(void)
 		// Render interpolated frames
 		if (uncappedFPS)
 			D_Display();
+
+		// use the spare time to read ahead
+		W_ServicePrefetch();
 	}
 
 	// run the count dics
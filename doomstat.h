@@ -51,6 +51,12 @@ extern boolean monoSound;
 extern boolean lowSound;
 extern boolean waitInit;
 extern boolean noMelt;
+extern boolean prelitTextures;
+extern boolean tiledFlats;
+extern boolean usePVS;
+extern boolean linearView;
+extern boolean wadImage;
+extern boolean showTimings;
 
 extern boolean reverseStereo;
 
@@ -74,6 +74,10 @@ char *t6text = T6TEXT;
 char *finaletext;
 char *finaleflat;
 
+// background currently held in screens[1]
+int finalebacklump;
+int finalebackscroll;
+
 void F_StartCast(void);
 void F_CastTicker(void);
 boolean F_CastResponder(event_t *ev);
@@ -262,6 +266,7 @@ void F_StartFinale(void)
 	S_ChangeMusic(finalemusic, true);
 	finalestage = 0;
 	finalecount = 0;
+	finalebacklump = -1;
 }
 
 boolean F_Responder(event_t *event)
@@ -313,6 +318,34 @@ void F_Ticker(void)
 	}
 }
 
+//
+// F_SetBackground
+// Returns true if screens[1] has to be redrawn.
+//
+boolean F_SetBackground(int lump, int scroll)
+{
+	if (lump == finalebacklump && scroll == finalebackscroll)
+		return false;
+
+	finalebacklump = lump;
+	finalebackscroll = scroll;
+	V_RefreshPatches();
+	return true;
+}
+
+//
+// F_DrawBackground
+//
+void F_DrawBackground(char *name)
+{
+	int lump;
+
+	lump = W_GetNumForName(name);
+
+	if (F_SetBackground(lump, 0))
+		V_DrawPatch(0, 0, 1, W_CacheLumpNum(lump, PU_CACHE));
+}
+
 //
 // F_TextWrite
 //
@@ -331,22 +364,26 @@ void F_TextWrite(void)
 	int c;
 	int cx;
 	int cy;
+	int lump;
 
 	// erase the entire screen to a tiled background
-	src = W_CacheLumpName(finaleflat, PU_CACHE);
-	dest = screens[0];
+	lump = W_GetNumForName(finaleflat);
 
-	for (y = 0; y < SCREENHEIGHT; y++)
+	if (F_SetBackground(lump, 0))
 	{
-		for (x = 0; x < SCREENWIDTH / 64; x++)
+		src = W_CacheLumpNum(lump, PU_CACHE);
+		dest = screens[1];
+
+		for (y = 0; y < SCREENHEIGHT; y++)
 		{
-			memcpy(dest, src + ((y & 63) << 6), 64);
-			dest += 64;
+			for (x = 0; x < SCREENWIDTH / 64; x++)
+			{
+				memcpy(dest, src + ((y & 63) << 6), 64);
+				dest += 64;
+			}
 		}
 	}
 
-	V_MarkRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
-
 	// draw some of the text onto the screen
 	cx = 10;
 	cy = 10;
@@ -377,7 +414,7 @@ void F_TextWrite(void)
 		w = SHORT(hu_font[c]->width);
 		if (cx + w > SCREENWIDTH)
 			break;
-		V_DrawPatch(cx, cy, 0, hu_font[c]);
+		V_ListPatch(cx, cy, hu_font[c], false);
 		cx += w;
 	}
 }
@@ -649,7 +686,7 @@ void F_CastPrint(char *text)
 		}
 
 		w = SHORT(hu_font[c]->width);
-		V_DrawPatch(cx, 180, 0, hu_font[c]);
+		V_ListPatch(cx, 180, hu_font[c], false);
 		cx += w;
 	}
 }
@@ -657,8 +694,6 @@ void F_CastPrint(char *text)
 //
 // F_CastDrawer
 //
-void V_DrawPatchFlipped(int x, int y, int scrn, patch_t *patch);
-
 void F_CastDrawer(void)
 {
 	spritedef_t *sprdef;
@@ -668,7 +703,7 @@ void F_CastDrawer(void)
 	patch_t *patch;
 
 	// erase the entire screen to a background
-	V_DrawPatch(0, 0, 0, W_CacheLumpName("BOSSBACK", PU_CACHE));
+	F_DrawBackground("BOSSBACK");
 
 	F_CastPrint(castorder[castnum].name);
 
@@ -679,10 +714,7 @@ void F_CastDrawer(void)
 	flip = (boolean)sprframe->flip[0];
 
 	patch = W_CacheLumpNum(lump + firstspritelump, PU_CACHE);
-	if (flip)
-		V_DrawPatchFlipped(160, 170, 0, patch);
-	else
-		V_DrawPatch(160, 170, 0, patch);
+	V_ListPatch(160, 170, patch, flip);
 }
 
 //
@@ -699,7 +731,7 @@ void F_DrawPatchCol(int x,
 	int count;
 
 	column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
-	desttop = screens[0] + x;
+	desttop = screens[1] + x;
 
 	// step through the posts in a column
 	while (column->topdelta != 0xff)
@@ -730,31 +762,33 @@ void F_BunnyScroll(void)
 	int stage;
 	static int laststage;
 
-	p1 = W_CacheLumpName("PFUB2", PU_LEVEL);
-	p2 = W_CacheLumpName("PFUB1", PU_LEVEL);
-
-	V_MarkRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
-
 	scrolled = 320 - (finalecount - 230) / 2;
 	if (scrolled > 320)
 		scrolled = 320;
 	if (scrolled < 0)
 		scrolled = 0;
 
-	for (x = 0; x < SCREENWIDTH; x++)
+	// only rebuild the picture while it is scrolling
+	if (F_SetBackground(W_GetNumForName("PFUB2"), scrolled))
 	{
-		if (x + scrolled < 320)
-			F_DrawPatchCol(x, p1, x + scrolled);
-		else
-			F_DrawPatchCol(x, p2, x + scrolled - 320);
+		p1 = W_CacheLumpName("PFUB2", PU_LEVEL);
+		p2 = W_CacheLumpName("PFUB1", PU_LEVEL);
+
+		for (x = 0; x < SCREENWIDTH; x++)
+		{
+			if (x + scrolled < 320)
+				F_DrawPatchCol(x, p1, x + scrolled);
+			else
+				F_DrawPatchCol(x, p2, x + scrolled - 320);
+		}
 	}
 
 	if (finalecount < 1130)
 		return;
 	if (finalecount < 1180)
 	{
-		V_DrawPatch((SCREENWIDTH - 13 * 8) / 2,
-					(SCREENHEIGHT - 8 * 8) / 2, 0, W_CacheLumpName("END0", PU_CACHE));
+		V_ListPatch((SCREENWIDTH - 13 * 8) / 2,
+					(SCREENHEIGHT - 8 * 8) / 2, W_CacheLumpName("END0", PU_CACHE), false);
 		laststage = 0;
 		return;
 	}
@@ -769,7 +803,7 @@ void F_BunnyScroll(void)
 	}
 
 	sprintf(name, "END%i", stage);
-	V_DrawPatch((SCREENWIDTH - 13 * 8) / 2, (SCREENHEIGHT - 8 * 8) / 2, 0, W_CacheLumpName(name, PU_CACHE));
+	V_ListPatch((SCREENWIDTH - 13 * 8) / 2, (SCREENHEIGHT - 8 * 8) / 2, W_CacheLumpName(name, PU_CACHE), false);
 }
 
 //
@@ -778,12 +812,8 @@ void F_BunnyScroll(void)
 void F_Drawer(void)
 {
 	if (finalestage == 2)
-	{
 		F_CastDrawer();
-		return;
-	}
-
-	if (!finalestage)
+	else if (!finalestage)
 		F_TextWrite();
 	else
 	{
@@ -791,25 +821,23 @@ void F_Drawer(void)
 		{
 		case 1:
 #if (EXE_VERSION < EXE_VERSION_ULTIMATE)
-			V_DrawPatch(0, 0, 0,
-						W_CacheLumpName("HELP2", PU_CACHE));
+			F_DrawBackground("HELP2");
 			break;
 #else
-			V_DrawPatch(0, 0, 0,
-						W_CacheLumpName("CREDIT", PU_CACHE));
+			F_DrawBackground("CREDIT");
 			break;
 #endif
 		case 2:
-			V_DrawPatch(0, 0, 0,
-						W_CacheLumpName("VICTORY2", PU_CACHE));
+			F_DrawBackground("VICTORY2");
 			break;
 		case 3:
 			F_BunnyScroll();
 			break;
 		case 4:
-			V_DrawPatch(0, 0, 0,
-						W_CacheLumpName("ENDPIC", PU_CACHE));
+			F_DrawBackground("ENDPIC");
 			break;
 		}
 	}
+
+	V_FlushPatches(menuactive || paused);
 }
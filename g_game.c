@@ -1257,7 +1257,7 @@ boolean G_CheckDemoStatus(void)
             }
         }
 
-        I_Error("Timed %i gametics in %i realtics. FPS: %i.%03i", gametic, realtics, resultfps >> FRACBITS, ((resultfps & 65535) * 1000) >> FRACBITS);
+        I_Error("Timed %i gametics in %i realtics. FPS: %i.%03i\nRenderer arena peak: %i bytes\nZone compaction: %i bytes moved in %i tics", gametic, realtics, resultfps >> FRACBITS, ((resultfps & 65535) * 1000) >> FRACBITS, arenapeak, zonemoved, zonecompacttics);
     }
 
     if (demoplayback)
@@ -28,6 +28,7 @@
 #include "r_local.h"
 #include "sounds.h"
 #include "i_system.h"
+#include "i_ibm.h"
 #include "i_sound.h"
 #include "g_game.h"
 #include "m_misc.h"
@@ -264,148 +265,64 @@ byte *pcscreen, *currentscreen, *destscreen, *destview;
 
 //
 // I_UpdateBox
+// The box is widened to 8 pixel blocks and copied
+//  plane by plane with I_CopyBoxPlane.
 //
 void I_UpdateBox(int x, int y, int w, int h)
 {
-    int i, j, k, count;
+    int i;
     int sp_x1, sp_x2;
-    int poffset;
-    int offset;
-    int pstep;
-    int step;
     byte *dest, *source;
 
     sp_x1 = x / 8;
     sp_x2 = (x + w) / 8;
-    count = sp_x2 - sp_x1 + 1;
-    offset = Mul320(y) + sp_x1 * 8;
-    step = SCREENWIDTH - count * 8;
-    poffset = offset / 4;
-    pstep = step / 4;
-
-    outp(SC_INDEX, SC_MAPMASK);
 
-    if (!(count & 1))
-    {
-        // 32-bit copy
+    if (sp_x2 > SCREENWIDTH / 8 - 1)
+        sp_x2 = SCREENWIDTH / 8 - 1;
 
-        for (i = 0; i < 4; i++)
-        {
-            outp(SC_INDEX + 1, 1 << i);
-            source = &screens[0][offset + i];
-            dest = destscreen + poffset;
+    source = screens[0] + Mul320(y) + sp_x1 * 8;
+    dest = destscreen + Mul80(y) + sp_x1 * 2;
 
-            for (j = 0; j < h; j++)
-            {
-                k = count / 2;
-
-                while (k--)
-                {
-                    *(unsigned int *)dest = (unsigned int)(((*(source + 12)) << 24) + ((*(source + 8)) << 16) + ((*(source + 4)) << 8) + (*source));
-                    dest += 4;
-                    source += 16;
-                }
+    outp(SC_INDEX, SC_MAPMASK);
 
-                source += step;
-                dest += pstep;
-            }
-        }
-    }
-    else
+    for (i = 0; i < 4; i++)
     {
-        // 16-bit copy
-
-        for (i = 0; i < 4; i++)
-        {
-            outp(SC_INDEX + 1, 1 << i);
-            source = &screens[0][offset + i];
-            dest = destscreen + poffset;
-
-            for (j = 0; j < h; j++)
-            {
-                k = count;
-
-                while (k--)
-                {
-                    *(unsigned short *)dest = (unsigned short)(((*(source + 4)) << 8) + (*source));
-                    dest += 2;
-                    source += 8;
-                }
-
-                source += step;
-                dest += pstep;
-            }
-        }
+        outp(SC_INDEX + 1, 1 << i);
+        I_CopyBoxPlane(dest, source + i, sp_x1, sp_x2, h);
     }
 }
 
 //
 // I_UpdateNoBlit
+// Every page keeps the list of rectangles that changed
+//  since it was last drawn to, so with three pages a
+//  change is copied three times and nothing else is.
 //
-int olddb[2][4];
+dirtyrect_t pagedirty[3][MAXDIRTYRECTS];
+int numpagedirty[3];
+
 void I_UpdateNoBlit(void)
 {
-    int realdr[4];
-    int x, y, w, h;
+    dirtyrect_t *r;
+    int page;
+    int i;
+
     // Set current screen
     currentscreen = destscreen;
 
-    // Update dirtybox size
-    realdr[BOXTOP] = dirtybox[BOXTOP];
-    if (realdr[BOXTOP] < olddb[0][BOXTOP])
-    {
-        realdr[BOXTOP] = olddb[0][BOXTOP];
-    }
-    if (realdr[BOXTOP] < olddb[1][BOXTOP])
-    {
-        realdr[BOXTOP] = olddb[1][BOXTOP];
-    }
+    for (page = 0; page < 3; page++)
+        for (i = 0; i < numdirtyrects; i++)
+            V_AddDirtyRect(pagedirty[page], &numpagedirty[page], &dirtyrects[i]);
 
-    realdr[BOXRIGHT] = dirtybox[BOXRIGHT];
-    if (realdr[BOXRIGHT] < olddb[0][BOXRIGHT])
-    {
-        realdr[BOXRIGHT] = olddb[0][BOXRIGHT];
-    }
-    if (realdr[BOXRIGHT] < olddb[1][BOXRIGHT])
-    {
-        realdr[BOXRIGHT] = olddb[1][BOXRIGHT];
-    }
+    numdirtyrects = 0;
 
-    realdr[BOXBOTTOM] = dirtybox[BOXBOTTOM];
-    if (realdr[BOXBOTTOM] > olddb[0][BOXBOTTOM])
-    {
-        realdr[BOXBOTTOM] = olddb[0][BOXBOTTOM];
-    }
-    if (realdr[BOXBOTTOM] > olddb[1][BOXBOTTOM])
-    {
-        realdr[BOXBOTTOM] = olddb[1][BOXBOTTOM];
-    }
-
-    realdr[BOXLEFT] = dirtybox[BOXLEFT];
-    if (realdr[BOXLEFT] > olddb[0][BOXLEFT])
-    {
-        realdr[BOXLEFT] = olddb[0][BOXLEFT];
-    }
-    if (realdr[BOXLEFT] > olddb[1][BOXLEFT])
-    {
-        realdr[BOXLEFT] = olddb[1][BOXLEFT];
-    }
+    // Update screen
+    page = ((int)destscreen - 0xa0000) >> 14;
 
-    // Leave current box for next update
-    memcpy(olddb[0], olddb[1], 16);
-    memcpy(olddb[1], dirtybox, 16);
+    for (i = 0, r = pagedirty[page]; i < numpagedirty[page]; i++, r++)
+        I_UpdateBox(r->x1, r->y1, r->x2 - r->x1 + 1, r->y2 - r->y1 + 1);
 
-    // Update screen
-    if (realdr[BOXBOTTOM] <= realdr[BOXTOP])
-    {
-        x = realdr[BOXLEFT];
-        y = realdr[BOXBOTTOM];
-        w = realdr[BOXRIGHT] - realdr[BOXLEFT] + 1;
-        h = realdr[BOXTOP] - realdr[BOXBOTTOM] + 1;
-        I_UpdateBox(x, y, w, h);
-    }
-    // Clear box
-    M_ClearBox(dirtybox);
+    numpagedirty[page] = 0;
 }
 
 //
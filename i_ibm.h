@@ -1,5 +1,13 @@
+#include "doomtype.h"
 #include "doomdef.h"
 
 extern int ticcount;
 extern fixed_t fps;
 extern int lastpress;
+
+// Screen copies to one plane of a page (i_plane.c).
+void I_CopyPlane16(byte *dest, byte *source, int height);
+void I_CopyBoxPlane(byte *dest, byte *source, int x1, int x2, int height);
+
+// 16 pixel aligned bands, 16 pixels a pass (planar.asm).
+void I_CopyPlane32(byte *dest, byte *source, int count, int height);
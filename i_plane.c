@@ -0,0 +1,68 @@
+//
+// Copyright (C) 1993-1996 Id Software, Inc.
+// Copyright (C) 2016-2017 Alexey Khokholov (Nuke.YKT)
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Copies of screens[0] to one plane of a VGA page.
+//	I_UpdateBox selects the plane, there is no port I/O
+//	here, so tools/planetest.c can check it on a host.
+//
+
+#include "doomdef.h"
+#include "i_ibm.h"
+
+//
+// I_CopyPlane16
+// One 8 pixel wide band of a plane, source points
+//  at the first pixel of the plane in screens[0].
+//
+void I_CopyPlane16(byte *dest, byte *source, int height)
+{
+    do
+    {
+        *(unsigned short *)dest = (unsigned short)((source[4] << 8) + source[0]);
+        source += SCREENWIDTH;
+        dest += SCREENWIDTH / 4;
+    } while (--height);
+}
+
+//
+// I_CopyBoxPlane
+// Copies blocks x1 to x2 (8 pixels each) of height rows,
+//  dest and source point at block x1 of the first row.
+// Everything but a leading and a trailing block is
+//  copied in 16 pixel aligned 32-bit writes.
+//
+void I_CopyBoxPlane(byte *dest, byte *source, int x1, int x2, int height)
+{
+    int lead;
+    int trail;
+    int count;
+
+    // the copy loops run at least once
+    if (height <= 0 || x2 < x1)
+        return;
+
+    lead = x1 & 1;
+    count = (x2 + 1 - x1 - lead) >> 1;
+    trail = (x2 + 1 - x1 - lead) & 1;
+
+    if (lead)
+        I_CopyPlane16(dest, source, height);
+
+    if (count)
+        I_CopyPlane32(dest + lead * 2, source + lead * 8, count, height);
+
+    if (trail)
+        I_CopyPlane16(dest + (lead + count * 2) * 2, source + (lead + count * 2) * 8, height);
+}
@@ -186,7 +186,7 @@ int EV_DoCeiling(line_t *line,
 
 		// new door thinker
 		rtn = 1;
-		ceiling = Z_Malloc(sizeof(*ceiling), PU_LEVSPEC, 0);
+		ceiling = P_AllocThinker(tp_ceiling);
 
 		thinkercap.prev->next = &ceiling->thinker;
 		ceiling->thinker.next = &thinkercap;
@@ -624,6 +624,13 @@ seeyou:
             S_StartSound(actor, sound);
     }
 
+    // it will fight and die soon
+    R_PrefetchSprite(actor->sprite);
+    S_PrefetchSound(actor->info->attacksound);
+    S_PrefetchSound(actor->info->painsound);
+    S_PrefetchSound(actor->info->deathsound);
+    S_PrefetchSound(actor->info->activesound);
+
     P_SetMobjState(actor, actor->info->seestate);
 }
 
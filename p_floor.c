@@ -254,7 +254,7 @@ int EV_DoFloor(line_t *line,
 
 		// new floor thinker
 		rtn = 1;
-		floor = Z_Malloc(sizeof(*floor), PU_LEVSPEC, 0);
+		floor = P_AllocThinker(tp_floor);
 
 		thinkercap.prev->next = &floor->thinker;
 		floor->thinker.next = &thinkercap;
@@ -457,7 +457,7 @@ int EV_BuildStairs(line_t *line,
 
 		// new floor thinker
 		rtn = 1;
-		floor = Z_Malloc(sizeof(*floor), PU_LEVSPEC, 0);
+		floor = P_AllocThinker(tp_floor);
 
 		thinkercap.prev->next = &floor->thinker;
 		floor->thinker.next = &thinkercap;
@@ -515,7 +515,7 @@ int EV_BuildStairs(line_t *line,
 
 				sec = tsec;
 				secnum = newsecnum;
-				floor = Z_Malloc(sizeof(*floor), PU_LEVSPEC, 0);
+				floor = P_AllocThinker(tp_floor);
 
 				thinkercap.prev->next = &floor->thinker;
 				floor->thinker.next = &thinkercap;
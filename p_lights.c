@@ -65,7 +65,7 @@ void P_SpawnFireFlicker(sector_t *sector)
     // Nothing special about it during gameplay.
     sector->special = 0;
 
-    flick = Z_Malloc(sizeof(*flick), PU_LEVSPEC, 0);
+    flick = P_AllocThinker(tp_flicker);
 
     thinkercap.prev->next = &flick->thinker;
     flick->thinker.next = &thinkercap;
@@ -116,7 +116,7 @@ void P_SpawnLightFlash(sector_t *sector)
     // nothing special about it during gameplay
     sector->special = 0;
 
-    flash = Z_Malloc(sizeof(*flash), PU_LEVSPEC, 0);
+    flash = P_AllocThinker(tp_flash);
 
     thinkercap.prev->next = &flash->thinker;
     flash->thinker.next = &thinkercap;
@@ -168,7 +168,7 @@ void P_SpawnStrobeFlash(sector_t *sector,
 {
     strobe_t *flash;
 
-    flash = Z_Malloc(sizeof(*flash), PU_LEVSPEC, 0);
+    flash = P_AllocThinker(tp_strobe);
 
     thinkercap.prev->next = &flash->thinker;
     flash->thinker.next = &thinkercap;
@@ -295,7 +295,7 @@ void P_SpawnGlowingLight(sector_t *sector)
 {
     glow_t *g;
 
-    g = Z_Malloc(sizeof(*g), PU_LEVSPEC, 0);
+    g = P_AllocThinker(tp_glow);
 
     thinkercap.prev->next = &g->thinker;
     g->thinker.next = &thinkercap;
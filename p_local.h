@@ -64,6 +64,25 @@ extern thinker_t thinkercap;
 
 void P_InitThinkers(void);
 
+// Fixed size pools the thinkers are allocated from.
+typedef enum
+{
+    tp_mobj,
+    tp_ceiling,
+    tp_door,
+    tp_floor,
+    tp_plat,
+    tp_flicker,
+    tp_flash,
+    tp_strobe,
+    tp_glow,
+    NUMTHINKERPOOLS
+} thinkerpool_t;
+
+void P_ClearThinkerPools(void);
+void *P_AllocThinker(thinkerpool_t type);
+void P_FreeThinker(thinker_t *thinker);
+
 //
 // P_PSPR
 //
@@ -483,7 +483,7 @@ P_SpawnMobj(fixed_t x,
     state_t *st;
     mobjinfo_t *info;
 
-    mobj = Z_Malloc(sizeof(*mobj), PU_LEVEL, NULL);
+    mobj = P_AllocThinker(tp_mobj);
     memset(mobj, 0, sizeof(*mobj));
     info = &mobjinfo[type];
 
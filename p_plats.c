@@ -154,7 +154,7 @@ int EV_DoPlat(line_t *line,
 
 		// Find lowest & highest floors around sector
 		rtn = 1;
-		plat = Z_Malloc(sizeof(*plat), PU_LEVSPEC, 0);
+		plat = P_AllocThinker(tp_plat);
 
 		thinkercap.prev->next = &plat->thinker;
     	plat->thinker.next = &thinkercap;
@@ -23,6 +23,7 @@
 #include "z_zone.h"
 
 #include "m_misc.h"
+#include "d_main.h"
 
 #include "g_game.h"
 
@@ -436,7 +437,7 @@ void P_LoadBlockMap(int lump)
     int i;
     int count;
 
-    blockmaplump = W_CacheLumpNum(lump, PU_LEVEL);
+    blockmaplump = W_CacheLumpNumWritable(lump, PU_LEVEL);
     blockmap = blockmaplump + 4;
     count = W_LumpLength(lump) / 2;
 
@@ -495,22 +496,41 @@ void P_GroupLines(void)
         }
     }
 
-    // build line tables for each sector
+    // give each sector its part of the line table
     linebuffer = Z_Malloc(total * 4, PU_LEVEL, 0);
     sector = sectors;
     for (i = 0; i < numsectors; i++, sector++)
     {
-        M_ClearBox(bbox);
         sector->lines = linebuffer;
-        li = lines;
-        for (j = 0; j < numlines; j++, li++)
+        linebuffer += sector->linecount;
+        sector->linecount = 0;
+    }
+
+    // fill them in one pass over the lines,
+    //  still in line order
+    li = lines;
+    for (i = 0; i < numlines; i++, li++)
+    {
+        sector = li->frontsector;
+        sector->lines[sector->linecount++] = li;
+
+        if (li->backsector && li->backsector != li->frontsector)
         {
-            if (li->frontsector == sector || li->backsector == sector)
-            {
-                *linebuffer++ = li;
-                M_AddToBox(bbox, li->v1->x, li->v1->y);
-                M_AddToBox(bbox, li->v2->x, li->v2->y);
-            }
+            sector = li->backsector;
+            sector->lines[sector->linecount++] = li;
+        }
+    }
+
+    sector = sectors;
+    for (i = 0; i < numsectors; i++, sector++)
+    {
+        M_ClearBox(bbox);
+
+        for (j = 0; j < sector->linecount; j++)
+        {
+            li = sector->lines[j];
+            M_AddToBox(bbox, li->v1->x, li->v1->y);
+            M_AddToBox(bbox, li->v2->x, li->v2->y);
         }
 
         // set the degenmobj_t to the middle of the bounding box
@@ -560,8 +580,16 @@ void P_SetupLevel(int episode,
     // Make sure all sounds are stopped before Z_FreeTags.
     S_Start();
 
+    D_StartTimings();
+
     Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+    D_Timing("Z_FreeTags");
+
+    // close the holes the last level left behind
+    Z_Compact();
+    D_Timing("Z_Compact");
 
+    P_ClearThinkerPools();
     P_InitThinkers();
 
     // if working with a devlopment map, reload it
@@ -590,29 +618,47 @@ void P_SetupLevel(int episode,
 
     // note: most of this ordering is important
     P_LoadBlockMap(lumpnum + ML_BLOCKMAP);
+    D_Timing("P_LoadBlockMap");
     P_LoadVertexes(lumpnum + ML_VERTEXES);
+    D_Timing("P_LoadVertexes");
     P_LoadSectors(lumpnum + ML_SECTORS);
+    D_Timing("P_LoadSectors");
     P_LoadSideDefs(lumpnum + ML_SIDEDEFS);
+    D_Timing("P_LoadSideDefs");
 
     P_LoadLineDefs(lumpnum + ML_LINEDEFS);
+    D_Timing("P_LoadLineDefs");
     P_LoadSubsectors(lumpnum + ML_SSECTORS);
+    D_Timing("P_LoadSubsectors");
     P_LoadNodes(lumpnum + ML_NODES);
+    D_Timing("P_LoadNodes");
     P_LoadSegs(lumpnum + ML_SEGS);
+    D_Timing("P_LoadSegs");
 
     rejectmatrix = W_CacheLumpNum(lumpnum + ML_REJECT, PU_LEVEL);
+    D_Timing("Reject");
     P_GroupLines();
+    D_Timing("P_GroupLines");
+
+    R_InitPVS(lumpname);
+    D_Timing("R_InitPVS");
 
     bodyqueslot = 0;
     P_LoadThings(lumpnum + ML_THINGS);
+    D_Timing("P_LoadThings");
 
     // clear special respawning que
     iquehead = iquetail = 0;
 
     // set up world state
     P_SpawnSpecials();
+    D_Timing("P_SpawnSpecials");
 
     // preload graphics
     R_PrecacheLevel();
+    D_Timing("R_PrecacheLevel");
+
+    D_LogTimings(lumpname);
 }
 
 //
@@ -622,5 +668,6 @@ void P_Init(void)
 {
     P_InitSwitchList();
     P_InitPicAnims();
+    D_Timing("P_InitPicAnims");
     R_InitSprites(sprnames);
 }
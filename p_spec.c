@@ -1087,7 +1087,7 @@ int EV_DoDonut(line_t *line)
 			s3 = s2->lines[i]->backsector;
 
 			//	Spawn rising slime
-			floor = Z_Malloc(sizeof(*floor), PU_LEVSPEC, 0);
+			floor = P_AllocThinker(tp_floor);
 
 			thinkercap.prev->next = &floor->thinker;
 			floor->thinker.next = &thinkercap;
@@ -1106,7 +1106,7 @@ int EV_DoDonut(line_t *line)
 			floor->floordestheight = s3->floorheight;
 
 			//	Spawn lowering donut-hole
-			floor = Z_Malloc(sizeof(*floor), PU_LEVSPEC, 0);
+			floor = P_AllocThinker(tp_floor);
 
 			thinkercap.prev->next = &floor->thinker;
 			floor->thinker.next = &thinkercap;
@@ -26,7 +26,7 @@ int leveltime;
 
 //
 // THINKERS
-// All thinkers should be allocated by Z_Malloc
+// All thinkers should be allocated by P_AllocThinker
 // so they can be operated on uniformly.
 // The actual structures will vary in size,
 // but the first element must be thinker_t.
@@ -35,6 +35,100 @@ int leveltime;
 // Both the head and tail of the thinker list.
 thinker_t thinkercap;
 
+//
+// THINKER POOLS
+// Each kind of thinker is carved out of its own PU_LEVEL
+//  slabs, so spawning and removing them never walks the
+//  zone. The pool is stored in front of every item.
+// Freed items are queued through thinker.prev and reused
+//  last, P_RunThinkers still reads thinker.next after
+//  the free.
+//
+#define SLABITEMS 32
+
+typedef struct
+{
+    int size;
+    thinker_t *freehead;
+    thinker_t *freetail;
+} pool_t;
+
+pool_t thinkerpools[NUMTHINKERPOOLS] = {
+    {sizeof(mobj_t)},
+    {sizeof(ceiling_t)},
+    {sizeof(vldoor_t)},
+    {sizeof(floormove_t)},
+    {sizeof(plat_t)},
+    {sizeof(fireflicker_t)},
+    {sizeof(lightflash_t)},
+    {sizeof(strobe_t)},
+    {sizeof(glow_t)}};
+
+//
+// P_ClearThinkerPools
+// The slabs went away with the level.
+//
+void P_ClearThinkerPools(void)
+{
+    int i;
+
+    for (i = 0; i < NUMTHINKERPOOLS; i++)
+        thinkerpools[i].freehead = thinkerpools[i].freetail = NULL;
+}
+
+//
+// P_FreeThinker
+//
+void P_FreeThinker(thinker_t *thinker)
+{
+    pool_t *pool;
+
+    pool = ((pool_t **)thinker)[-1];
+
+    thinker->prev = NULL;
+
+    if (pool->freetail)
+        pool->freetail->prev = thinker;
+    else
+        pool->freehead = thinker;
+
+    pool->freetail = thinker;
+}
+
+//
+// P_AllocThinker
+//
+void *P_AllocThinker(thinkerpool_t type)
+{
+    pool_t *pool;
+    thinker_t *thinker;
+    byte *item;
+    int stride;
+    int i;
+
+    pool = &thinkerpools[type];
+
+    if (!pool->freehead)
+    {
+        stride = sizeof(pool_t *) + ((pool->size + 3) & ~3);
+        item = Z_Malloc(SLABITEMS * stride, PU_LEVEL, NULL);
+
+        for (i = 0; i < SLABITEMS; i++, item += stride)
+        {
+            *(pool_t **)item = pool;
+            P_FreeThinker((thinker_t *)(item + sizeof(pool_t *)));
+        }
+    }
+
+    thinker = pool->freehead;
+    pool->freehead = thinker->prev;
+
+    if (!pool->freehead)
+        pool->freetail = NULL;
+
+    return thinker;
+}
+
 //
 // P_InitThinkers
 //
@@ -58,7 +152,7 @@ void P_RunThinkers(void)
             // time to remove it
             currentthinker->next->prev = currentthinker->prev;
             currentthinker->prev->next = currentthinker->next;
-            Z_Free(currentthinker);
+            P_FreeThinker(currentthinker);
         }
         else
         {
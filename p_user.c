@@ -215,6 +215,8 @@ void P_PlayerThink(player_t *player)
 	else
 		player->mo->flags &= ~MF_NOCLIP;
 
+	R_PrefetchSector(player->mo->subsector->sector);
+
 	// chain saw run forward
 	cmd = &player->cmd;
 	if (player->mo->flags & MF_JUSTATTACKED)
@@ -23,9 +23,12 @@
 
 EXTRN	_destview:DWORD
 EXTRN	_centery:DWORD
+EXTRN	_flatspotx:DWORD
+EXTRN	_flatspoty:DWORD
 
 pixelcount dd 0
 loopcount dd 0
+planestep dd 0
 
 
 ;=================================
@@ -173,6 +176,138 @@ done:
 	ret
 ENDP
 
+;
+; R_DrawColumnLit
+; Same as R_DrawColumn, the source column already
+; has the light level applied, so no colormap.
+;
+PROC  R_DrawColumnLitPotato_
+PUBLIC  R_DrawColumnLitPotato_
+	PUSHR
+	mov		ebp,[_dc_yl]
+	cmp 	ebp,[_dc_yh]
+	jg		litdone
+	lea		edi,[ebp+ebp*4]
+	sal		edi,4
+	mov		ebx,[_dc_x]
+	add		edi,ebx
+	add		edi,[_destview]
+	mov		eax,15
+	mov		edx,SC_INDEX+1
+	out		dx,al
+	jmp		litdraw
+ENDP
+
+PROC  R_DrawColumnLitLow_
+PUBLIC  R_DrawColumnLitLow_
+	PUSHR
+	mov		ebp,[_dc_yl]
+	cmp 	ebp,[_dc_yh]
+	jg		litdone
+	lea		edi,[ebp+ebp*4]
+	shl		edi,4
+	mov		ebx,[_dc_x]
+	mov		ecx,ebx
+	shr		ebx,1
+	add		edi,ebx
+	add		edi,[_destview]
+	and 	ecx,1
+	shl		ecx,1
+	mov		eax,3
+	shl		eax,cl
+	mov		edx,SC_INDEX+1
+	out		dx,al
+	jmp		litdraw
+ENDP
+
+PROC  R_DrawColumnLit_
+PUBLIC  R_DrawColumnLit_
+	PUSHR
+	mov		ebp,[_dc_yl]
+	cmp		ebp,[_dc_yh]
+	jg		litdone
+	lea		edi,[ebp+ebp*4]
+	shl		edi,4
+	mov		ebx,[_dc_x]
+	mov		ecx,ebx
+	shr		ebx,2
+	add		edi,ebx
+	add		edi,[_destview]
+	and		ecx,3
+	mov		eax,1
+	shl		eax,cl
+	mov		edx,SC_INDEX+1
+	out		dx,al
+litdraw:
+	mov		eax,[_dc_yh]
+	inc		eax
+	sub		eax,ebp						; pixel count
+	mov		[pixelcount],eax			; save for final pixel
+	js		litdone						; nothing to scale
+	shr		eax,1						; double pixel count
+	mov		[loopcount],eax
+
+	mov		ecx,[_dc_iscale]
+
+	mov		eax,[_centery]
+	sub		eax,ebp
+	imul	ecx
+	mov		ebp,[_dc_texturemid]
+	sub		ebp,eax
+	shl		ebp,9						; 7 significant bits, 25 frac
+
+	mov		esi,[_dc_source]
+
+	mov		ebx,[_dc_iscale]
+	shl		ebx,9
+	mov		eax,OFFSET litpatch1+2		; convice tasm to modify code...
+	mov		[eax],ebx
+	mov		eax,OFFSET litpatch2+2		; convice tasm to modify code...
+	mov		[eax],ebx
+
+; al,bl		pixels
+; ecx,edx	scratch
+; esi		virtual source
+; edi		moving destination pointer
+; ebp		frac
+
+	mov		ecx,ebp						; begin calculating first pixel
+	add		ebp,ebx						; advance frac pointer
+	shr		ecx,25						; finish calculation for first pixel
+	mov		edx,ebp						; begin calculating second pixel
+	add		ebp,ebx						; advance frac pointer
+	shr		edx,25						; finish calculation for second pixel
+	mov		al,[esi+ecx]				; get first pixel
+	mov		bl,[esi+edx]				; get second pixel
+
+	test	[pixelcount],0fffffffeh
+	jnz		litloop						; at least two pixels to map
+	jmp		litlast
+litloop:
+	mov		ecx,ebp						; begin calculating third pixel
+litpatch1:
+	add		ebp,12345678h				; advance frac pointer
+	mov		[edi],al					; write first pixel
+	shr		ecx,25						; finish calculation for third pixel
+	mov		edx,ebp						; begin calculating fourth pixel
+litpatch2:
+	add		ebp,12345678h				; advance frac pointer
+	mov		[edi+SCREENWIDTH/4],bl		; write second pixel
+	shr		edx,25						; finish calculation for fourth pixel
+	mov		al,[esi+ecx]				; get third pixel
+	add		edi,SCREENWIDTH/2			; advance to third pixel destination
+	mov		bl,[esi+edx]				; get fourth pixel
+	dec		[loopcount]					; done with loop?
+	jnz		litloop
+litlast:
+	test	[pixelcount],1
+	jz		litdone
+	mov		[edi],al					; write final pixel
+litdone:
+	POPR
+	ret
+ENDP
+
 .DATA
 
 dest dd 0
@@ -348,6 +483,364 @@ hdone:
 	POPR
 	ret
 ENDP
+
+;
+; R_DrawSpanLit
+; Same as R_DrawSpan for pre-lit flats, no colormap.
+;
+PROC   R_DrawSpanLit_
+PUBLIC	R_DrawSpanLit_
+	PUSHR
+	mov		eax,[_ds_x1]
+	mov		[curx],eax
+	mov 	ebx,eax
+	and		ebx,3
+	mov		[endplane],ebx
+	mov		[curplane],ebx
+	shr		eax,2
+	mov		ebp,[_ds_y]
+	lea		edi,[ebp+ebp*4]
+	shl		edi,4
+	add		edi,eax
+	add		edi,[_destview]
+	mov		[dest],edi
+
+	mov		ebx,[_ds_xfrac]
+	shl		ebx,10
+	and		ebx,0ffff0000h
+	mov		eax,[_ds_yfrac]
+	shr		eax,6
+	and		eax,0ffffh
+	or		ebx,eax
+
+	mov		[frac],ebx
+
+	mov		ebx,[_ds_xstep]
+	shl		ebx,10
+	and		ebx,0ffff0000h
+	mov		eax,[_ds_ystep]
+	shr		eax,6
+	and		eax,0ffffh
+	or		ebx,eax
+
+	mov		[fracstep],ebx
+
+	shl		ebx,2
+	mov		[fracpstep],ebx
+	mov		eax,OFFSET hlpatch1+2
+	mov		[eax],ebx
+	mov		eax,OFFSET hlpatch2+2
+	mov		[eax],ebx
+	mov		ecx,[curplane]
+hlplane:
+	mov		eax,1
+	shl		eax,cl
+	mov		edx,SC_INDEX+1
+	out		dx,al
+	mov		eax,[_ds_x2]
+	cmp		eax,[curx]
+	jb		hldone
+	sub		eax,[curplane]
+	js		hldoneplane
+	shr		eax,2
+	mov		[endpx],eax
+	dec		eax
+	js		hlfillone
+	shr		eax,1
+	mov		ebx,[curx]
+	shr		ebx,2
+	cmp		ebx,[endpx]
+	jz		hlfillone
+	mov		[curpx],ebx
+	inc		ebx
+	shr		ebx,1
+	inc		eax
+	sub		eax,ebx
+	js		hldoneplane
+	mov		[loopcount],eax
+	mov		esi,[_ds_source]
+	mov		edi,[dest]
+	mov		ebp,[frac]
+	test	[curpx],1
+	jz		hlfill
+	shld	ecx,ebp,22
+	shld	ecx,ebp,6
+	add		ebp,[fracpstep]
+	and		ecx,0fffh
+	mov		al,[esi+ecx]
+	mov		[edi],al
+	inc		edi
+	jz		hldoneplane
+hlfill:
+	shld	ecx,ebp,22
+	shld	ecx,ebp,6
+	add		ebp,[fracpstep]
+	and		ecx,0fffh
+	shld	edx,ebp,22
+	shld	edx,ebp,6
+	add		ebp,[fracpstep]
+	and		edx,0fffh
+	mov		al,[esi+ecx]
+	mov		ah,[esi+edx]
+	test	[loopcount],0ffffffffh
+	jnz		hldoubleloop
+	jmp		hlchecklast
+hlfillone:
+	mov		esi,[_ds_source]
+	mov		edi,[dest]
+	mov		ebp,[frac]
+	shld	ecx,ebp,22
+	shld	ecx,ebp,6
+	and		ecx,0fffh
+	mov		al,[esi+ecx]
+	mov		[edi],al
+	jmp		hldoneplane
+hldoubleloop:
+	shld	ecx,ebp,22
+	shld	ecx,ebp,6
+hlpatch1:
+	add		ebp,12345678h
+	and		ecx,0fffh
+	mov		[edi],ax
+	shld	edx,ebp,22
+	add		edi,2
+	shld	edx,ebp,6
+hlpatch2:
+	add		ebp,12345678h
+	and		edx,0fffh
+	mov		al,[esi+ecx]
+	mov		ah,[esi+edx]
+	dec		[loopcount]
+	jnz		hldoubleloop
+hlchecklast:
+	test	[endpx],1
+	jnz		hldoneplane
+	mov		[edi],al
+hldoneplane:
+	mov		ecx,[curplane]
+	inc		ecx
+	and		ecx,3
+	jnz		hlskip
+	inc		[dest]
+hlskip:
+	cmp		ecx,[endplane]
+	jz		hldone
+	mov		[curplane],ecx
+	mov		ebx,[frac]
+	add		ebx,[fracstep]
+	mov		[frac],ebx
+	inc		[curx]
+	jmp		hlplane
+hldone:
+	POPR
+	ret
+ENDP
+
+;
+; R_DrawSpanTiled
+; Spans of flats in the -tiledflats layout.
+; u and v hold the 6 bit integer part of the texture
+; coordinate on every other bit from bit 20, u on the
+; even bits and v on the odd ones, and the fraction in
+; bits 4-19. The bits of the other coordinate are kept
+; set, so a step carries straight through them, and
+; (u & v) >> 20 is the texel in the tiled flat.
+;
+
+UGAPS	=	0aaa00000h
+VGAPS	=	055500000h
+
+; 16.16 coordinate in eax to u or v, without the gaps,
+; through the flatspot table of its axis. Uses ecx.
+DILATE	MACRO	spots
+	mov		ecx,eax
+	shr		eax,16
+	and		eax,63
+	mov		eax,[spots+eax*4]
+	shl		eax,20
+	and		ecx,0ffffh
+	shl		ecx,4
+	or		eax,ecx
+ENDM
+
+.DATA
+
+tilehigh db 1,2,4,8
+tilelow db 3,12
+tilemasks dd 0
+tileplanes dd 0
+tileshift dd 0
+tilelit dd 0
+tilerow dd 0
+tilex dd 0
+tileleft dd 0
+tileu dd 0
+tilev dd 0
+tileustep dd 0
+tilevstep dd 0
+
+.CODE
+
+PROC   R_DrawSpanTiled_
+PUBLIC	R_DrawSpanTiled_
+	PUSHR
+	mov		[tilelit],0
+	jmp		thigh
+ENDP
+
+PROC   R_DrawSpanTiledLit_
+PUBLIC	R_DrawSpanTiledLit_
+	PUSHR
+	mov		[tilelit],1
+thigh:
+	mov		[tileplanes],4
+	mov		[tileshift],2
+	mov		[tilemasks],OFFSET tilehigh
+	jmp		tdraw
+ENDP
+
+PROC   R_DrawSpanTiledLow_
+PUBLIC	R_DrawSpanTiledLow_
+	PUSHR
+	mov		[tilelit],0
+	jmp		tlow
+ENDP
+
+PROC   R_DrawSpanTiledLitLow_
+PUBLIC	R_DrawSpanTiledLitLow_
+	PUSHR
+	mov		[tilelit],1
+tlow:
+	mov		[tileplanes],2
+	mov		[tileshift],1
+	mov		[tilemasks],OFFSET tilelow
+tdraw:
+	mov		eax,[_ds_x1]
+	cmp		eax,[_ds_x2]
+	jg		tdone
+	mov		[tilex],eax
+	mov		ebp,[_ds_y]
+	lea		edi,[ebp+ebp*4]
+	shl		edi,4
+	add		edi,[_destview]
+	mov		[tilerow],edi
+
+	mov		eax,[_ds_xfrac]
+	DILATE	_flatspotx
+	or		eax,UGAPS
+	mov		[tileu],eax
+	mov		eax,[_ds_yfrac]
+	DILATE	_flatspoty
+	or		eax,VGAPS
+	mov		[tilev],eax
+
+	mov		eax,[_ds_xstep]				; to the next plane
+	DILATE	_flatspotx
+	mov		[tileustep],eax
+	mov		eax,[_ds_ystep]
+	DILATE	_flatspoty
+	mov		[tilevstep],eax
+
+	mov		eax,[_ds_xstep]				; to the next pixel in a plane
+	imul	eax,[tileplanes]
+	DILATE	_flatspotx
+	mov		ebx,eax
+	mov		eax,[_ds_ystep]
+	imul	eax,[tileplanes]
+	DILATE	_flatspoty
+	mov		ecx,OFFSET tpatchu+2
+	mov		[ecx],ebx
+	mov		ecx,OFFSET tpatchlu+2
+	mov		[ecx],ebx
+	mov		ecx,OFFSET tpatchv+2
+	mov		[ecx],eax
+	mov		ecx,OFFSET tpatchlv+2
+	mov		[ecx],eax
+
+	mov		eax,[tileplanes]
+	mov		[tileleft],eax
+tplane:
+	mov		eax,[tilex]
+	mov		ebx,[_ds_x2]
+	sub		ebx,eax
+	js		tdone						; span narrower than the planes
+	mov		ecx,[tileshift]
+	shr		ebx,cl
+	inc		ebx							; pixels in this plane
+	mov		edi,eax
+	shr		edi,cl
+	add		edi,[tilerow]
+	mov		ecx,[tileplanes]
+	dec		ecx
+	and		ecx,eax
+	mov		edx,[tilemasks]
+	mov		al,[edx+ecx]
+	mov		edx,SC_INDEX+1
+	out		dx,al
+	mov		esi,[_ds_source]
+	mov		ebp,[tileu]
+	mov		edx,[tilev]
+	test	[tilelit],1
+	jnz		tlitloop
+	mov		eax,[_ds_colormap]
+
+; eax		aligned colormap
+; ebx		pixels left
+; ecx		texel
+; edx		v
+; esi		tiled flat
+; edi		moving destination pointer
+; ebp		u
+
+tloop:
+	mov		ecx,ebp
+	and		ecx,edx
+	shr		ecx,20
+tpatchu:
+	add		ebp,12345678h
+	or		ebp,UGAPS
+tpatchv:
+	add		edx,12345678h
+	or		edx,VGAPS
+	mov		al,[esi+ecx]
+	inc		edi
+	mov		al,[eax]
+	dec		ebx
+	mov		[edi-1],al
+	jnz		tloop
+	jmp		tnextplane
+tlitloop:
+	mov		ecx,ebp
+	and		ecx,edx
+	shr		ecx,20
+tpatchlu:
+	add		ebp,12345678h
+	or		ebp,UGAPS
+tpatchlv:
+	add		edx,12345678h
+	or		edx,VGAPS
+	mov		al,[esi+ecx]
+	inc		edi
+	dec		ebx
+	mov		[edi-1],al
+	jnz		tlitloop
+tnextplane:
+	dec		[tileleft]
+	jz		tdone
+	inc		[tilex]
+	mov		eax,[tileu]
+	add		eax,[tileustep]
+	or		eax,UGAPS
+	mov		[tileu],eax
+	mov		eax,[tilev]
+	add		eax,[tilevstep]
+	or		eax,VGAPS
+	mov		[tilev],eax
+	jmp		tplane
+tdone:
+	POPR
+	ret
+ENDP
 	
 PROC   R_DrawSpanLow_
 PUBLIC	R_DrawSpanLow_
@@ -506,4 +999,46 @@ ldone:
 	ret
 ENDP
 
+;
+; I_CopyPlane32
+; Copies one plane of a 16 pixel aligned band of
+; screens[0] to video memory, 16 pixels a pass.
+; eax = dest, edx = first pixel of the plane,
+; ebx = 16 pixel groups per row, ecx = rows
+;
+PROC  I_CopyPlane32_
+PUBLIC  I_CopyPlane32_
+	PUSHR
+	mov		edi,eax
+	mov		esi,edx
+	mov		ebp,ecx
+	lea		eax,[ebx*4]
+	neg		eax
+	add		eax,PLANEWIDTH
+	mov		[planestep],eax
+	mov		edx,ebx
+	shl		edx,4
+	neg		edx
+	add		edx,SCREENWIDTH
+crow:
+	mov		ecx,ebx
+cword:
+	mov		al,[esi+8]
+	mov		ah,[esi+12]
+	shl		eax,16
+	mov		al,[esi]
+	mov		ah,[esi+4]
+	mov		[edi],eax
+	add		esi,16
+	add		edi,4
+	dec		ecx
+	jnz		cword
+	add		esi,edx
+	add		edi,[planestep]
+	dec		ebp
+	jnz		crow
+	POPR
+	ret
+ENDP
+
 END
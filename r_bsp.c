@@ -21,11 +21,15 @@
 #include "m_misc.h"
 
 #include "i_system.h"
+#include "z_zone.h"
+#include "w_wad.h"
 
 #include "r_main.h"
 #include "r_plane.h"
 #include "r_things.h"
 
+#include "p_local.h"
+
 // State.
 #include "doomstat.h"
 #include "r_state.h"
@@ -36,8 +40,9 @@ line_t *linedef;
 sector_t *frontsector;
 sector_t *backsector;
 
-drawseg_t drawsegs[MAXDRAWSEGS];
+drawseg_t *drawsegs;
 drawseg_t *ds_p;
+int maxdrawsegs = MAXDRAWSEGS;
 
 void R_StoreWallRange(int start,
                       int stop);
@@ -47,109 +52,152 @@ void R_StoreWallRange(int start,
 //
 void R_ClearDrawSegs(void)
 {
+    drawsegs = R_ArenaAlloc(maxdrawsegs * sizeof(*drawsegs));
     ds_p = drawsegs;
 }
 
 //
-// ClipWallSegment
-// Clips the given range of columns
-// and includes it in the new clip list.
+// R_GrowDrawSegs
+// Moves the drawsegs to an array twice the size,
+//  nothing keeps pointers to them while the
+//  BSP is walked.
 //
-typedef struct
+void R_GrowDrawSegs(void)
 {
-    int first;
-    int last;
+    drawseg_t *newdrawsegs;
 
-} cliprange_t;
+    newdrawsegs = R_ArenaAlloc(maxdrawsegs * 2 * sizeof(*drawsegs));
+    memcpy(newdrawsegs, drawsegs, maxdrawsegs * sizeof(*drawsegs));
 
-#define MAXSEGS 32
+    drawsegs = newdrawsegs;
+    ds_p = drawsegs + maxdrawsegs;
+    maxdrawsegs *= 2;
+}
 
-// newend is one past the last valid seg
-cliprange_t *newend;
-cliprange_t solidsegs[MAXSEGS];
+//
+// ClipWallSegment
+// Clips the given range of columns
+// and includes it in the new clip list.
+//
+// The clip list is a bitmap with one bit per view
+//  column, set once a solid wall covers the column.
+// Columns past viewwidth are always set.
+//
+#define SOLIDWORDS ((SCREENWIDTH + 31) / 32)
+
+unsigned int solidcols[SOLIDWORDS];
 
 //
-// R_ClipSolidWallSegment
-// Does handle solid walls,
-//  e.g. single sided LineDefs (middle texture)
-//  that entirely block the view.
+// R_FirstOpenColumn
+// Returns the first column from x to last that is not
+//  covered by a solid wall, or last + 1 if there is none.
 //
-void R_ClipSolidWallSegment(int first,
-                            int last)
+int R_FirstOpenColumn(int x,
+                      int last)
 {
-    cliprange_t *next;
-    cliprange_t *start;
-
-    // Find the first range that touches the range
-    //  (adjacent pixels are touching).
-    start = solidsegs;
-    while (start->last < first - 1)
-        start++;
+    unsigned int bits;
 
-    if (first < start->first)
+    while (x <= last)
     {
-        if (last < start->first - 1)
+        bits = solidcols[x >> 5] >> (x & 31);
+
+        // Rest of the word is solid?
+        if (bits == 0xffffffffu >> (x & 31))
         {
-            // Post is entirely visible (above start),
-            //  so insert a new clippost.
-            R_StoreWallRange(first, last);
-            next = newend;
-            newend++;
-
-            // 1/11/98 killough: performance tuning using fast memmove
-            memmove(start + 1, start, (++newend - start) * sizeof(*start));
-            start->first = first;
-            start->last = last;
-            return;
+            x = (x | 31) + 1;
+            continue;
+        }
+
+        while (bits & 1)
+        {
+            bits >>= 1;
+            x++;
         }
 
-        // There is a fragment above *start.
-        R_StoreWallRange(first, start->first - 1);
-        // Now adjust the clip size.
-        start->first = first;
+        break;
     }
 
-    // Bottom contained in start?
-    if (last <= start->last)
-        return;
+    return x > last ? last + 1 : x;
+}
 
-    next = start;
-    while (last >= (next + 1)->first - 1)
+//
+// R_FirstSolidColumn
+// Returns the first column from x to last that is
+//  covered by a solid wall, or last + 1 if there is none.
+//
+int R_FirstSolidColumn(int x,
+                       int last)
+{
+    unsigned int bits;
+
+    while (x <= last)
     {
-        // There is a fragment between two posts.
-        R_StoreWallRange(next->last + 1, (next + 1)->first - 1);
-        next++;
+        bits = ~solidcols[x >> 5] >> (x & 31);
 
-        if (last <= next->last)
+        // Rest of the word is open?
+        if (bits == 0xffffffffu >> (x & 31))
         {
-            // Bottom is contained in next.
-            // Adjust the clip size.
-            start->last = next->last;
-            goto crunch;
+            x = (x | 31) + 1;
+            continue;
         }
+
+        while (bits & 1)
+        {
+            bits >>= 1;
+            x++;
+        }
+
+        break;
     }
 
-    // There is a fragment after *next.
-    R_StoreWallRange(next->last + 1, last);
-    // Adjust the clip size.
-    start->last = last;
+    return x > last ? last + 1 : x;
+}
 
-    // Remove start+1 to next from the clip list,
-    // because start now covers their area.
-crunch:
-    if (next == start)
+//
+// R_ClipSolidWallSegment
+// Does handle solid walls,
+//  e.g. single sided LineDefs (middle texture)
+//  that entirely block the view.
+//
+void R_ClipSolidWallSegment(int first,
+                            int last)
+{
+    int x;
+    int stop;
+    int w;
+    int w1;
+    int w2;
+    unsigned int mask1;
+    unsigned int mask2;
+
+    // Draw the columns still open.
+    x = R_FirstOpenColumn(first, last);
+
+    while (x <= last)
     {
-        // Post just extended past the bottom of one post.
-        return;
+        stop = R_FirstSolidColumn(x, last);
+        R_StoreWallRange(x, stop - 1);
+        x = R_FirstOpenColumn(stop, last);
     }
 
-    while (next++ != newend)
+    // Then mark the whole range solid.
+    w1 = first >> 5;
+    w2 = last >> 5;
+    mask1 = 0xffffffffu << (first & 31);
+    mask2 = 0xffffffffu >> (31 - (last & 31));
+
+    if (w1 == w2)
     {
-        // Remove a post.
-        *++start = *next;
+        solidcols[w1] |= mask1 & mask2;
+        return;
     }
 
-    newend = start + 1;
+    solidcols[w1] |= mask1;
+
+    for (w = w1 + 1; w < w2; w++)
+        solidcols[w] = 0xffffffffu;
+
+    solidcols[w2] |= mask2;
 }
 
 //
@@ -162,55 +210,53 @@ crunch:
 void R_ClipPassWallSegment(int first,
                            int last)
 {
-    cliprange_t *start;
+    int x;
+    int stop;
 
-    // Find the first range that touches the range
-    //  (adjacent pixels are touching).
-    start = solidsegs;
-    while (start->last < first - 1)
-        start++;
+    x = R_FirstOpenColumn(first, last);
 
-    if (first < start->first)
+    while (x <= last)
     {
-        if (last < start->first - 1)
-        {
-            // Post is entirely visible (above start).
-            R_StoreWallRange(first, last);
-            return;
-        }
-
-        // There is a fragment above *start.
-        R_StoreWallRange(first, start->first - 1);
+        stop = R_FirstSolidColumn(x, last);
+        R_StoreWallRange(x, stop - 1);
+        x = R_FirstOpenColumn(stop, last);
     }
+}
 
-    // Bottom contained in start?
-    if (last <= start->last)
-        return;
+//
+// R_ClearClipSegs
+//
+void R_ClearClipSegs(void)
+{
+    int w;
 
-    while (last >= (start + 1)->first - 1)
+    for (w = 0; w < SOLIDWORDS; w++)
     {
-        // There is a fragment between two posts.
-        R_StoreWallRange(start->last + 1, (start + 1)->first - 1);
-        start++;
-
-        if (last <= start->last)
-            return;
+        if (viewwidth >= (w + 1) * 32)
+            solidcols[w] = 0;
+        else if (viewwidth <= w * 32)
+            solidcols[w] = 0xffffffffu;
+        else
+            solidcols[w] = 0xffffffffu << (viewwidth & 31);
     }
-
-    // There is a fragment after *next.
-    R_StoreWallRange(start->last + 1, last);
 }
 
 //
-// R_ClearClipSegs
+// R_ViewFull
+// True once solid walls cover every column,
+//  nothing further back can be seen.
 //
-void R_ClearClipSegs(void)
+boolean R_ViewFull(void)
 {
-    solidsegs[0].first = -0x7fffffff;
-    solidsegs[0].last = -1;
-    solidsegs[1].first = viewwidth;
-    solidsegs[1].last = 0x7fffffff;
-    newend = solidsegs + 2;
+    int w;
+
+    for (w = 0; w < SOLIDWORDS; w++)
+    {
+        if (solidcols[w] != 0xffffffffu)
+            return false;
+    }
+
+    return true;
 }
 
 //
@@ -334,8 +380,6 @@ boolean R_CheckBBox(fixed_t *bspcoord)
     angle_t span;
     angle_t tspan;
 
-    cliprange_t *start;
-
     int sx1;
     int sx2;
 
@@ -447,17 +491,8 @@ boolean R_CheckBBox(fixed_t *bspcoord)
         return false;
     sx2--;
 
-    start = solidsegs;
-    while (start->last < sx2)
-        start++;
-
-    if (sx1 >= start->first && sx2 <= start->last)
-    {
-        // The clippost contains the new span.
-        return false;
-    }
-
-    return true;
+    // Any column of the span still open?
+    return R_FirstOpenColumn(sx1, sx2) <= sx2;
 }
 
 //
@@ -477,6 +512,14 @@ void R_Subsector(int num)
     count = sub->numlines;
     line = &segs[sub->firstline];
 
+    if (markonly)
+    {
+        while (count--)
+            R_AddLine(line++);
+
+        return;
+    }
+
     if (frontsector->floorheight < viewz)
     {
         floorplane = R_FindPlane(frontsector->floorheight,
@@ -504,6 +547,160 @@ void R_Subsector(int num)
     }
 }
 
+//
+// POTENTIALLY VISIBLE SET
+// With -pvs, subtrees of the BSP that can not be seen
+//  from the subsector the view is in are skipped.
+// The set comes from a <map>PVS side lump if the WAD has
+//  one: a row of (numsubsectors + 7) / 8 bytes for each
+//  subsector, bit (s & 7) of byte (s >> 3) set if
+//  subsector s might be visible from it.
+// Without the lump it is worked out from the REJECT
+//  matrix, with the same sector to sector rules
+//  P_CheckSight uses.
+//
+// Whenever the view moves to another row of the set,
+//  every visible subsector stamps itself and the nodes
+//  above it with pvsstamp.
+//
+byte *pvsdata;
+int pvsrowsize;
+int *nodeparent;
+int *subsectorparent;
+int *nodepvs;
+int *subsectorpvs;
+int pvsstamp;
+int pvsrow;
+
+//
+// R_InitPVS
+// Called by P_SetupLevel after the nodes
+//  and the REJECT matrix are loaded.
+//
+void R_InitPVS(char *mapname)
+{
+    int i;
+    int lump;
+    char name[9];
+
+    if (!usePVS)
+        return;
+
+    nodeparent = Z_Malloc(numnodes * sizeof(*nodeparent), PU_LEVEL, 0);
+    subsectorparent = Z_Malloc(numsubsectors * sizeof(*subsectorparent), PU_LEVEL, 0);
+    nodepvs = Z_Malloc(numnodes * sizeof(*nodepvs), PU_LEVEL, 0);
+    subsectorpvs = Z_Malloc(numsubsectors * sizeof(*subsectorpvs), PU_LEVEL, 0);
+
+    memset(nodepvs, 0, numnodes * sizeof(*nodepvs));
+    memset(subsectorpvs, 0, numsubsectors * sizeof(*subsectorpvs));
+
+    for (i = 0; i < numsubsectors; i++)
+        subsectorparent[i] = -1;
+
+    for (i = 0; i < numnodes; i++)
+        nodeparent[i] = -1;
+
+    for (i = 0; i < numnodes; i++)
+    {
+        if (nodes[i].children[0] & NF_SUBSECTOR)
+            subsectorparent[nodes[i].children[0] & ~NF_SUBSECTOR] = i;
+        else
+            nodeparent[nodes[i].children[0]] = i;
+
+        if (nodes[i].children[1] & NF_SUBSECTOR)
+            subsectorparent[nodes[i].children[1] & ~NF_SUBSECTOR] = i;
+        else
+            nodeparent[nodes[i].children[1]] = i;
+    }
+
+    pvsstamp = 0;
+    pvsrow = -1;
+    pvsrowsize = (numsubsectors + 7) / 8;
+
+    // Side lump, if it matches the level.
+    sprintf(name, "%.5sPVS", mapname);
+    lump = W_GetNumForName(name);
+
+    if (lump != -1 && W_LumpLength(lump) == pvsrowsize * numsubsectors)
+        pvsdata = W_CacheLumpNum(lump, PU_LEVEL);
+    else
+        pvsdata = NULL;
+}
+
+//
+// R_UpdatePVS
+// Stamps what can be seen from the subsector
+//  the view is in, if that changed.
+//
+void R_UpdatePVS(subsector_t *viewsub)
+{
+    int i;
+    int row;
+    int node;
+    int bitnum;
+    int pnum;
+    byte *bits;
+
+    if (pvsdata)
+        row = viewsub - subsectors;
+    else
+        row = viewsub->sector - sectors;
+
+    if (row == pvsrow)
+        return;
+
+    pvsrow = row;
+    pvsstamp++;
+
+    for (i = 0; i < numsubsectors; i++)
+    {
+        if (pvsdata)
+        {
+            bits = pvsdata + row * pvsrowsize;
+
+            if (!(bits[i >> 3] & (1 << (i & 7))))
+                continue;
+        }
+        else
+        {
+            // Same test as P_CheckSight.
+            pnum = row * numsectors + (subsectors[i].sector - sectors);
+            bitnum = 1 << (pnum & 7);
+
+            if (rejectmatrix[pnum >> 3] & bitnum)
+                continue;
+        }
+
+        subsectorpvs[i] = pvsstamp;
+
+        for (node = subsectorparent[i]; node != -1 && nodepvs[node] != pvsstamp; node = nodeparent[node])
+            nodepvs[node] = pvsstamp;
+    }
+
+    // The view always sees where it is.
+    i = viewsub - subsectors;
+    subsectorpvs[i] = pvsstamp;
+
+    for (node = subsectorparent[i]; node != -1 && nodepvs[node] != pvsstamp; node = nodeparent[node])
+        nodepvs[node] = pvsstamp;
+}
+
+//
+// R_PVSHidden
+// True if nothing below this BSP child
+//  can be seen from the view subsector.
+//
+boolean R_PVSHidden(int bspnum)
+{
+    if (!usePVS || bspnum == -1)
+        return false;
+
+    if (bspnum & NF_SUBSECTOR)
+        return subsectorpvs[bspnum & ~NF_SUBSECTOR] != pvsstamp;
+
+    return nodepvs[bspnum] != pvsstamp;
+}
+
 //
 // RenderBSPNode
 // Renders all subsectors below a given node,
@@ -530,6 +727,9 @@ void R_RenderBSPNode(int bspnum)
             if (sp == MAX_BSP_DEPTH)
                 break;
 
+            if (R_PVSHidden(bspnum))
+                break;
+
             bsp = &nodes[bspnum];
 
             //decide which side the view point is on
@@ -551,7 +751,7 @@ void R_RenderBSPNode(int bspnum)
 
         if (bspnum == -1)
             R_Subsector(0);
-        else
+        else if (!R_PVSHidden(bspnum))
             R_Subsector(bspnum & (~NF_SUBSECTOR));
 
         if (sp == 0)
@@ -560,6 +760,11 @@ void R_RenderBSPNode(int bspnum)
             return;
         }
 
+        // Walls cover the whole view,
+        //  the rest of the tree is hidden.
+        if (R_ViewFull())
+            return;
+
         //Back sides.
 
         sp--;
@@ -571,7 +776,7 @@ void R_RenderBSPNode(int bspnum)
         // Possibly divide back space.
         //Walk back up the tree until we find
         //a node that has a visible backspace.
-        while (!R_CheckBBox(bsp->bbox[side ^ 1]))
+        while (R_PVSHidden(bsp->children[side ^ 1]) || !R_CheckBBox(bsp->bbox[side ^ 1]))
         {
             if (sp == 0)
             {
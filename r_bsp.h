@@ -36,15 +36,21 @@ extern boolean markceiling;
 
 extern boolean skymap;
 
-extern drawseg_t drawsegs[MAXDRAWSEGS];
+extern drawseg_t *drawsegs;
 extern drawseg_t *ds_p;
+extern int maxdrawsegs;
 
 typedef void (*drawfunc_t)(int start, int stop);
 
 // BSP?
 void R_ClearClipSegs(void);
 void R_ClearDrawSegs(void);
+void R_GrowDrawSegs(void);
 
 void R_RenderBSPNode(int bspnum);
 
+// Potentially visible set (-pvs).
+void R_InitPVS(char *mapname);
+void R_UpdatePVS(subsector_t *viewsub);
+
 #endif
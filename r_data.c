@@ -17,8 +17,12 @@
 //	generation of lookups, caching, retrieval by name.
 //
 
+#include <sys/stat.h>
+
 #include "i_system.h"
 #include "z_zone.h"
+#include "m_misc.h"
+#include "d_main.h"
 
 #include "w_wad.h"
 
@@ -132,10 +136,27 @@ short **texturecolumnlump;
 unsigned short **texturecolumnofs;
 byte **texturecomposite;
 
+// opaque rows of masked midtextures, see R_CacheMaskedExtents
+short **texturemaskedextent;
+
 // for global animation
 int *flattranslation;
 int *texturetranslation;
 
+//
+// Flat layout.
+// Texel (x, y) of a cached flat is at
+//  flatspotx[x] + flatspoty[y].
+// Normally that is the row major lump layout, with
+//  -tiledflats the flats are converted to Morton order
+//  when cached, so texels close in u and v are close
+//  in memory whatever the direction of the span. The
+//  tiled span drawers keep u and v in that order too.
+//
+int flatspotx[64];
+int flatspoty[64];
+byte **flattiled;
+
 // needed for pre rendering
 fixed_t *spritewidth;
 fixed_t *spriteoffset;
@@ -143,6 +164,53 @@ fixed_t *spritetopoffset;
 
 lighttable_t *colormaps;
 
+// sprites converted by R_CacheFastSprite
+fastpatch_t **spritefast;
+
+//
+// PRE-LIT CACHE
+// With -prelit, the most used wall textures and flats
+//  of a level get copies with the light levels they
+//  can be seen at already applied, so the drawers
+//  can skip the colormap lookup.
+// Lit textures are stored as 128 texel columns, only
+//  textures at least that tall are cached so the
+//  wrap matches R_DrawColumn.
+//
+#define PRELITBUDGET (512 * 1024)
+#define PRELITBUDGETRAM (4 * 1024 * 1024)
+
+byte **texturelit;
+byte **flatlit;
+
+//
+// INDEX CACHE
+// R_InitTextures and R_InitSpriteLumps cache every patch
+//  and sprite in the WADs to build their tables, and
+//  R_InitSpriteDefs checks every sprite lump name for
+//  every sprite. The tables are saved to INDEXCACHE and
+//  read back on the next start, as long as the same WAD
+//  files, with the same sizes and dates, are loaded.
+//
+#define INDEXCACHE "fdoom.idx"
+#define INDEXVERSION 1
+
+typedef struct
+{
+    char id[4];
+    int version;
+    int length;
+    int numlumps;
+    int numsprites;
+    int modified;
+    int filesize[MAXWADFILES];
+    int filetime[MAXWADFILES];
+} indexheader_t;
+
+byte *indexcache;
+byte *indexpos;
+int indexlength;
+
 //
 // MAPTEXTURE_T CACHING
 // When a texture is first needed,
@@ -362,10 +430,96 @@ R_GetColumn(int tex,
 
     if (!texturecomposite[tex])
         R_GenerateComposite(tex);
+    else
+        Z_Touch(texturecomposite[tex]);
 
     return texturecomposite[tex] + ofs;
 }
 
+//
+// R_CacheMaskedExtents
+// Returns the first and one past the last opaque row
+//  of every column of a masked midtexture, two shorts
+//  for each column up to texturewidthmask. Columns that
+//  are not plain patch posts get 0, MAXSHORT.
+//
+short *R_CacheMaskedExtents(int tex)
+{
+    column_t *column;
+    short *extent;
+    int width;
+    int top;
+    int bottom;
+    int x;
+
+    if (texturemaskedextent[tex])
+    {
+        Z_Touch(texturemaskedextent[tex]);
+        return texturemaskedextent[tex];
+    }
+
+    // Static until filled, caching the patches
+    //  could purge it otherwise.
+    extent = Z_Malloc((texturewidthmask[tex] + 1) * 4, PU_STATIC, &texturemaskedextent[tex]);
+    width = textures[tex]->width;
+
+    for (x = 0; x <= texturewidthmask[tex]; x++)
+    {
+        if (x >= width || texturecolumnlump[tex][x] <= 0)
+        {
+            extent[x * 2] = 0;
+            extent[x * 2 + 1] = MAXSHORT;
+            continue;
+        }
+
+        column = (column_t *)(R_GetColumn(tex, x) - 3);
+        top = MAXSHORT;
+        bottom = 0;
+
+        for (; column->topdelta != 0xff; column = (column_t *)((byte *)column + column->length + 4))
+        {
+            if (!column->length)
+                continue;
+
+            if (column->topdelta < top)
+                top = column->topdelta;
+
+            if (column->topdelta + column->length > bottom)
+                bottom = column->topdelta + column->length;
+        }
+
+        extent[x * 2] = top;
+        extent[x * 2 + 1] = bottom;
+    }
+
+    Z_ChangeTag(extent, PU_CACHE);
+
+    return extent;
+}
+
+//
+// R_GetLitColumn
+// Returns NULL if the texture has no copy
+//  at the given light level.
+//
+byte *
+R_GetLitColumn(int tex,
+               int col,
+               int level)
+{
+    byte *lit;
+
+    if (level >= NUMCOLORMAPS)
+        return NULL;
+
+    lit = texturelit[tex * NUMCOLORMAPS + level];
+
+    if (!lit)
+        return NULL;
+
+    return lit + ((col & texturewidthmask[tex]) << 7);
+}
+
 void GenerateTextureHashTable(void)
 {
     texture_t **rover;
@@ -406,6 +560,64 @@ void GenerateTextureHashTable(void)
     }
 }
 
+//
+// R_AllocTextures
+//
+void R_AllocTextures(void)
+{
+    textures = Z_Malloc(numtextures * 4, PU_STATIC, 0);
+    texturecolumnlump = Z_Malloc(numtextures * 4, PU_STATIC, 0);
+    texturecolumnofs = Z_Malloc(numtextures * 4, PU_STATIC, 0);
+    texturecomposite = Z_Malloc(numtextures * 4, PU_STATIC, 0);
+    texturecompositesize = Z_Malloc(numtextures * 4, PU_STATIC, 0);
+    texturewidthmask = Z_Malloc(numtextures * 4, PU_STATIC, 0);
+    textureheight = Z_Malloc(numtextures * 4, PU_STATIC, 0);
+    texturemaskedextent = Z_Malloc(numtextures * 4, PU_STATIC, 0);
+    memset(texturemaskedextent, 0, numtextures * 4);
+}
+
+//
+// R_ReadIndexTextures
+// The texture tables from the index cache,
+//  as R_InitTextures left them.
+//
+void R_ReadIndexTextures(void)
+{
+    texture_t *texture;
+    short patchcount;
+    int size;
+    int i;
+
+    R_ReadIndex(&numtextures, sizeof(numtextures));
+    R_AllocTextures();
+
+    for (i = 0; i < numtextures; i++)
+    {
+        R_ReadIndex(&patchcount, sizeof(patchcount));
+        size = sizeof(texture_t) + sizeof(texpatch_t) * (patchcount - 1);
+        texture = textures[i] = Z_Malloc(size, PU_STATIC, 0);
+        R_ReadIndex(texture, size);
+
+        texturecolumnlump[i] = Z_Malloc(texture->width * 2, PU_STATIC, 0);
+        texturecolumnofs[i] = Z_Malloc(texture->width * 2, PU_STATIC, 0);
+        R_ReadIndex(texturecolumnlump[i], texture->width * 2);
+        R_ReadIndex(texturecolumnofs[i], texture->width * 2);
+
+        R_ReadIndex(&texturecompositesize[i], sizeof(int));
+        R_ReadIndex(&texturewidthmask[i], sizeof(int));
+        R_ReadIndex(&textureheight[i], sizeof(fixed_t));
+        texturecomposite[i] = 0;
+    }
+
+    // Create translation table for global animation.
+    texturetranslation = Z_Malloc((numtextures + 1) * 4, PU_STATIC, 0);
+
+    for (i = 0; i < numtextures; i++)
+        texturetranslation[i] = i;
+
+    GenerateTextureHashTable();
+}
+
 //
 // R_InitTextures
 // Initializes the texture list
@@ -445,6 +657,12 @@ void R_InitTextures(void)
     int temp2;
     int temp3;
 
+    if (indexcache)
+    {
+        R_ReadIndexTextures();
+        return;
+    }
+
     // Load the patch names from pnames.lmp.
     name[8] = 0;
     names = W_CacheLumpName("PNAMES", PU_STATIC);
@@ -481,13 +699,7 @@ void R_InitTextures(void)
     }
     numtextures = numtextures1 + numtextures2;
 
-    textures = Z_Malloc(numtextures * 4, PU_STATIC, 0);
-    texturecolumnlump = Z_Malloc(numtextures * 4, PU_STATIC, 0);
-    texturecolumnofs = Z_Malloc(numtextures * 4, PU_STATIC, 0);
-    texturecomposite = Z_Malloc(numtextures * 4, PU_STATIC, 0);
-    texturecompositesize = Z_Malloc(numtextures * 4, PU_STATIC, 0);
-    texturewidthmask = Z_Malloc(numtextures * 4, PU_STATIC, 0);
-    textureheight = Z_Malloc(numtextures * 4, PU_STATIC, 0);
+    R_AllocTextures();
 
     totalwidth = 0;
 
@@ -592,6 +804,64 @@ void R_InitFlats(void)
 
     for (i = 0; i < numflats; i++)
         flattranslation[i] = i;
+
+    for (i = 0; i < 64; i++)
+    {
+        if (tiledFlats)
+        {
+            flatspotx[i] = (i & 1) | (i & 2) << 1 | (i & 4) << 2 |
+                           (i & 8) << 3 | (i & 16) << 4 | (i & 32) << 5;
+            flatspoty[i] = flatspotx[i] << 1;
+        }
+        else
+        {
+            flatspotx[i] = i;
+            flatspoty[i] = i * 64;
+        }
+    }
+
+    if (tiledFlats)
+    {
+        flattiled = Z_Malloc(numflats * sizeof(*flattiled), PU_STATIC, 0);
+        memset(flattiled, 0, numflats * sizeof(*flattiled));
+    }
+}
+
+//
+// R_CacheTiledFlat
+// Returns the flat converted to the tiled layout,
+//  cached with the given tag.
+//
+byte *R_CacheTiledFlat(int flat, int tag)
+{
+    int x;
+    int y;
+    byte *dest;
+    byte *source;
+    byte *lump;
+
+    if (flattiled[flat])
+    {
+        Z_ChangeTag(flattiled[flat], tag);
+        return flattiled[flat];
+    }
+
+    // both are static while converting, either
+    //  allocation could purge the other
+    lump = W_CacheLumpNum(firstflat + flat, PU_STATIC);
+    dest = Z_Malloc(64 * 64, PU_STATIC, &flattiled[flat]);
+    source = lump;
+
+    for (y = 0; y < 64; y++)
+    {
+        for (x = 0; x < 64; x++)
+            dest[flatspotx[x] + flatspoty[y]] = *source++;
+    }
+
+    Z_ChangeTag(lump, PU_CACHE);
+    Z_ChangeTag(dest, tag);
+
+    return dest;
 }
 
 //
@@ -612,6 +882,16 @@ void R_InitSpriteLumps(void)
     spritewidth = Z_Malloc(numspritelumps * 4, PU_STATIC, 0);
     spriteoffset = Z_Malloc(numspritelumps * 4, PU_STATIC, 0);
     spritetopoffset = Z_Malloc(numspritelumps * 4, PU_STATIC, 0);
+    spritefast = Z_Malloc(numspritelumps * 4, PU_STATIC, 0);
+    memset(spritefast, 0, numspritelumps * 4);
+
+    if (indexcache)
+    {
+        R_ReadIndex(spritewidth, numspritelumps * 4);
+        R_ReadIndex(spriteoffset, numspritelumps * 4);
+        R_ReadIndex(spritetopoffset, numspritelumps * 4);
+        return;
+    }
 
     for (i = 0; i < numspritelumps; i++)
     {
@@ -625,6 +905,107 @@ void R_InitSpriteLumps(void)
     }
 }
 
+//
+// R_CacheFastSprite
+// Returns the sprite lump (from firstspritelump)
+//  in the fast patch format, converting it if
+//  it is not cached yet.
+//
+fastpatch_t *R_CacheFastSprite(int lump)
+{
+    patch_t *patch;
+    column_t *column;
+    fastpatch_t *fast;
+    fastcolumn_t *fastcol;
+    fastpost_t *post;
+    byte *texels;
+    int width;
+    int numposts;
+    int numtexels;
+    int size;
+    int x;
+
+    if (spritefast[lump])
+    {
+        Z_Touch(spritefast[lump]);
+        return spritefast[lump];
+    }
+
+    patch = W_CacheLumpNum(firstspritelump + lump, PU_STATIC);
+    width = SHORT(patch->width);
+
+    // Merging only removes posts, so this is enough.
+    numposts = 0;
+    numtexels = 0;
+
+    for (x = 0; x < width; x++)
+    {
+        column = (column_t *)((byte *)patch + LONG(patch->columnofs[x]));
+
+        for (; column->topdelta != 0xff; column = (column_t *)((byte *)column + column->length + 4))
+        {
+            numposts++;
+            numtexels += column->length;
+        }
+    }
+
+    size = sizeof(fastpatch_t) + (width - 1) * sizeof(fastcolumn_t);
+    size = (size + 3) & ~3;
+
+    fast = Z_Malloc(size + numposts * sizeof(fastpost_t) + numtexels,
+                    PU_CACHE, &spritefast[lump]);
+
+    fast->width = width;
+    fast->posts = size;
+
+    post = (fastpost_t *)((byte *)fast + size);
+    texels = (byte *)(post + numposts);
+    numposts = 0;
+
+    for (x = 0; x < width; x++)
+    {
+        column = (column_t *)((byte *)patch + LONG(patch->columnofs[x]));
+        fastcol = &fast->columns[x];
+        fastcol->firstpost = numposts;
+        fastcol->numposts = 0;
+        fastcol->top = 0;
+        fastcol->bottom = 0;
+
+        for (; column->topdelta != 0xff; column = (column_t *)((byte *)column + column->length + 4))
+        {
+            if (!column->length)
+                continue;
+
+            // Touches the last post?
+            if (fastcol->numposts && post[-1].topdelta + post[-1].length == column->topdelta && post[-1].length + column->length <= 128)
+            {
+                post[-1].length += column->length;
+            }
+            else
+            {
+                post->topdelta = column->topdelta;
+                post->length = column->length;
+                post->data = texels - (byte *)fast;
+                post++;
+
+                if (!fastcol->numposts)
+                    fastcol->top = column->topdelta;
+
+                fastcol->numposts++;
+                numposts++;
+            }
+
+            memcpy(texels, (byte *)column + 3, column->length);
+            texels += column->length;
+            fastcol->bottom = column->topdelta + column->length;
+        }
+    }
+
+    Z_ChangeTag(patch, PU_CACHE);
+
+    return fast;
+}
+
 //
 // R_InitColormaps
 //
@@ -641,6 +1022,167 @@ void R_InitColormaps(void)
     W_ReadLump(lump, colormaps);
 }
 
+//
+// R_InitPrelit
+//
+void R_InitPrelit(void)
+{
+    texturelit = Z_Malloc(numtextures * NUMCOLORMAPS * sizeof(*texturelit), PU_STATIC, 0);
+    memset(texturelit, 0, numtextures * NUMCOLORMAPS * sizeof(*texturelit));
+
+    flatlit = Z_Malloc(numflats * NUMCOLORMAPS * sizeof(*flatlit), PU_STATIC, 0);
+    memset(flatlit, 0, numflats * NUMCOLORMAPS * sizeof(*flatlit));
+}
+
+//
+// R_IndexHeader
+// Identifies the WAD files the tables come from.
+//
+void R_IndexHeader(indexheader_t *header)
+{
+    struct stat fileinfo;
+    char *name;
+    int i;
+
+    memset(header, 0, sizeof(*header));
+    memcpy(header->id, "FDIX", 4);
+    header->version = INDEXVERSION;
+    header->numlumps = numlumps;
+    header->numsprites = NUMSPRITES;
+    header->modified = modifiedgame;
+
+    for (i = 0; i < MAXWADFILES && wadfiles[i]; i++)
+    {
+        name = wadfiles[i];
+
+        // reload files are loaded without the tilde
+        if (name[0] == '~')
+            name++;
+
+        if (stat(name, &fileinfo) == -1)
+        {
+            header->filesize[i] = -1;
+            continue;
+        }
+
+        header->filesize[i] = fileinfo.st_size;
+        header->filetime[i] = fileinfo.st_mtime;
+    }
+}
+
+//
+// R_OpenIndexCache
+// Reads the index cache, if it matches the WAD files.
+//
+void R_OpenIndexCache(void)
+{
+    indexheader_t header;
+    struct stat fileinfo;
+
+    indexcache = NULL;
+
+    if (stat(INDEXCACHE, &fileinfo) == -1 || fileinfo.st_size < sizeof(header))
+        return;
+
+    R_IndexHeader(&header);
+    header.length = M_ReadFile(INDEXCACHE, &indexcache);
+
+    if (memcmp(indexcache, &header, sizeof(header)))
+    {
+        Z_Free(indexcache);
+        indexcache = NULL;
+        return;
+    }
+
+    indexpos = indexcache + sizeof(header);
+}
+
+//
+// R_ReadIndex
+//
+void R_ReadIndex(void *dest, int size)
+{
+    memcpy(dest, indexpos, size);
+    indexpos += size;
+}
+
+//
+// R_WriteIndex
+// Only counts the size until the cache is allocated.
+//
+void R_WriteIndex(void *source, int size)
+{
+    if (indexcache)
+        memcpy(indexcache + indexlength, source, size);
+
+    indexlength += size;
+}
+
+//
+// R_WriteIndexTables
+// Same order the init functions read them back in.
+//
+void R_WriteIndexTables(void)
+{
+    int i;
+
+    indexlength = sizeof(indexheader_t);
+
+    R_WriteIndex(&numtextures, sizeof(numtextures));
+
+    for (i = 0; i < numtextures; i++)
+    {
+        R_WriteIndex(&textures[i]->patchcount, sizeof(short));
+        R_WriteIndex(textures[i], sizeof(texture_t) + sizeof(texpatch_t) * (textures[i]->patchcount - 1));
+        R_WriteIndex(texturecolumnlump[i], textures[i]->width * 2);
+        R_WriteIndex(texturecolumnofs[i], textures[i]->width * 2);
+        R_WriteIndex(&texturecompositesize[i], sizeof(int));
+        R_WriteIndex(&texturewidthmask[i], sizeof(int));
+        R_WriteIndex(&textureheight[i], sizeof(fixed_t));
+    }
+
+    R_WriteIndex(spritewidth, numspritelumps * 4);
+    R_WriteIndex(spriteoffset, numspritelumps * 4);
+    R_WriteIndex(spritetopoffset, numspritelumps * 4);
+
+    for (i = 0; i < numsprites; i++)
+    {
+        R_WriteIndex(&sprites[i].numframes, sizeof(int));
+        R_WriteIndex(sprites[i].spriteframes, sprites[i].numframes * sizeof(spriteframe_t));
+    }
+}
+
+//
+// R_CloseIndexCache
+// Called once R_InitSpriteDefs is done. Frees the cache
+//  if the tables came from it, or writes a new one.
+//
+void R_CloseIndexCache(void)
+{
+    indexheader_t *header;
+
+    if (indexcache)
+    {
+        Z_Free(indexcache);
+        indexcache = NULL;
+        return;
+    }
+
+    R_WriteIndexTables();
+
+    indexcache = Z_Malloc(indexlength, PU_STATIC, 0);
+    header = (indexheader_t *)indexcache;
+    R_IndexHeader(header);
+    R_WriteIndexTables();
+    header->length = indexlength;
+
+    // a read only directory just means no cache
+    M_WriteFile(INDEXCACHE, indexcache, indexlength);
+
+    Z_Free(indexcache);
+    indexcache = NULL;
+}
+
 //
 // R_InitData
 // Locates all the lumps
@@ -649,13 +1191,22 @@ void R_InitColormaps(void)
 //
 void R_InitData(void)
 {
+    R_OpenIndexCache();
+    D_Timing(indexcache ? "R_OpenIndexCache (hit)" : "R_OpenIndexCache (miss)");
     R_InitTextures();
+    D_Timing("R_InitTextures");
     printf(".");
     R_InitFlats();
+    D_Timing("R_InitFlats");
     printf(".");
     R_InitSpriteLumps();
+    D_Timing("R_InitSpriteLumps");
     printf(".");
     R_InitColormaps();
+    D_Timing("R_InitColormaps");
+
+    if (prelitTextures)
+        R_InitPrelit();
 }
 
 //
@@ -707,6 +1258,333 @@ int R_TextureNumForName(char *name)
     return -1;
 }
 
+//
+// R_WallLightMask
+// Colormap levels a wall at this light can use,
+//  as set up by R_ExecuteSetViewSize for a full view.
+//
+unsigned R_WallLightMask(int lightnum)
+{
+    int j;
+    int level;
+    int startmap;
+    unsigned mask;
+
+    if (lightnum < 0)
+        lightnum = 0;
+
+    if (lightnum >= LIGHTLEVELS)
+        lightnum = LIGHTLEVELS - 1;
+
+    startmap = ((LIGHTLEVELS - 1 - lightnum) * 2) * NUMCOLORMAPS / LIGHTLEVELS;
+    mask = 0;
+
+    for (j = 0; j < MAXLIGHTSCALE; j++)
+    {
+        level = startmap - j / DISTMAP;
+
+        if (level < 0)
+            level = 0;
+
+        if (level >= NUMCOLORMAPS)
+            level = NUMCOLORMAPS - 1;
+
+        mask |= 1 << level;
+    }
+
+    return mask;
+}
+
+//
+// R_PlaneLightMask
+// Colormap levels a flat at this light can use.
+//
+unsigned R_PlaneLightMask(int lightnum)
+{
+    int j;
+    unsigned mask;
+
+    mask = 0;
+
+    for (j = 0; j < MAXLIGHTZ; j++)
+        mask |= 1 << ((zlight[lightnum][j] - colormaps) >> 8);
+
+    return mask;
+}
+
+//
+// R_BuildLitTexture
+//
+void R_BuildLitTexture(int tex, int level)
+{
+    int x;
+    int y;
+    int width;
+    byte *dest;
+    byte *source;
+    lighttable_t *colormap;
+
+    width = texturewidthmask[tex] + 1;
+    colormap = colormaps + level * 256;
+
+    dest = Z_Malloc(width * 128, PU_LEVEL, &texturelit[tex * NUMCOLORMAPS + level]);
+
+    for (x = 0; x < width; x++)
+    {
+        source = R_GetColumn(tex, x);
+
+        for (y = 0; y < 128; y++)
+            *dest++ = colormap[source[y]];
+    }
+}
+
+//
+// R_BuildLitFlat
+//
+void R_BuildLitFlat(int flat, int level)
+{
+    int x;
+    int y;
+    byte *dest;
+    byte *source;
+    lighttable_t *colormap;
+
+    colormap = colormaps + level * 256;
+
+    dest = Z_Malloc(64 * 64, PU_LEVEL, &flatlit[flat * NUMCOLORMAPS + level]);
+    source = W_CacheLumpNum(firstflat + flat, PU_CACHE);
+
+    for (y = 0; y < 64; y++)
+    {
+        for (x = 0; x < 64; x++)
+            dest[flatspotx[x] + flatspoty[y]] = colormap[*source++];
+    }
+}
+
+//
+// R_PrecacheLit
+// Builds pre-lit copies of the most used textures
+//  and flats until the budget runs out.
+// The copies are PU_LEVEL, so they go away
+//  with the level.
+//
+void R_PrecacheLit(void)
+{
+    int *textureuses;
+    int *flatuses;
+    unsigned *texturelevels;
+    unsigned *flatlevels;
+    unsigned wallmask[LIGHTLEVELS];
+    unsigned planemask[LIGHTLEVELS];
+    unsigned mask;
+    int budget;
+    int best;
+    int bestuses;
+    int isflat;
+    int size;
+    int level;
+    int i;
+    side_t *side;
+    sector_t *sector;
+
+    for (i = 0; i < LIGHTLEVELS; i++)
+    {
+        planemask[i] = R_PlaneLightMask(i);
+        wallmask[i] = R_WallLightMask(i);
+    }
+
+    // Fake contrast moves walls one light level either way.
+    for (i = 0; i < LIGHTLEVELS; i++)
+        wallmask[i] |= R_WallLightMask(i - 1) | R_WallLightMask(i + 1);
+
+    textureuses = alloca(numtextures * sizeof(*textureuses));
+    texturelevels = alloca(numtextures * sizeof(*texturelevels));
+    memset(textureuses, 0, numtextures * sizeof(*textureuses));
+    memset(texturelevels, 0, numtextures * sizeof(*texturelevels));
+
+    flatuses = alloca(numflats * sizeof(*flatuses));
+    flatlevels = alloca(numflats * sizeof(*flatlevels));
+    memset(flatuses, 0, numflats * sizeof(*flatuses));
+    memset(flatlevels, 0, numflats * sizeof(*flatlevels));
+
+    for (i = 0, side = sides; i < numsides; i++, side++)
+    {
+        mask = wallmask[side->sector->lightlevel >> LIGHTSEGSHIFT];
+
+        textureuses[side->toptexture]++;
+        texturelevels[side->toptexture] |= mask;
+        textureuses[side->midtexture]++;
+        texturelevels[side->midtexture] |= mask;
+        textureuses[side->bottomtexture]++;
+        texturelevels[side->bottomtexture] |= mask;
+    }
+
+    for (i = 0, sector = sectors; i < numsectors; i++, sector++)
+    {
+        mask = planemask[sector->lightlevel >> LIGHTSEGSHIFT];
+
+        flatuses[sector->floorpic]++;
+        flatlevels[sector->floorpic] |= mask;
+        flatuses[sector->ceilingpic]++;
+        flatlevels[sector->ceilingpic] |= mask;
+    }
+
+    // "NoTexture", the sky and short textures are never cached.
+    textureuses[0] = 0;
+    textureuses[skytexture] = 0;
+    flatuses[skyflatnum] = 0;
+
+    for (i = 0; i < numtextures; i++)
+    {
+        if (textureheight[i] < 128 * FRACUNIT)
+            textureuses[i] = 0;
+    }
+
+    budget = unlimitedRAM ? PRELITBUDGETRAM : PRELITBUDGET;
+
+    // Most used first, until nothing fits.
+    while (budget > 0)
+    {
+        best = -1;
+        bestuses = 0;
+        isflat = 0;
+
+        for (i = 0; i < numtextures; i++)
+        {
+            if (textureuses[i] > bestuses)
+            {
+                best = i;
+                bestuses = textureuses[i];
+            }
+        }
+
+        for (i = 0; i < numflats; i++)
+        {
+            if (flatuses[i] > bestuses)
+            {
+                best = i;
+                bestuses = flatuses[i];
+                isflat = 1;
+            }
+        }
+
+        if (best == -1)
+            break;
+
+        if (isflat)
+        {
+            flatuses[best] = 0;
+
+            for (level = 0; level < NUMCOLORMAPS && budget >= 64 * 64; level++)
+            {
+                if (!(flatlevels[best] & (1 << level)) || flatlit[best * NUMCOLORMAPS + level])
+                    continue;
+
+                R_BuildLitFlat(best, level);
+                budget -= 64 * 64;
+            }
+        }
+        else
+        {
+            textureuses[best] = 0;
+            size = (texturewidthmask[best] + 1) * 128;
+
+            for (level = 0; level < NUMCOLORMAPS && budget >= size; level++)
+            {
+                if (!(texturelevels[best] & (1 << level)) || texturelit[best * NUMCOLORMAPS + level])
+                    continue;
+
+                R_BuildLitTexture(best, level);
+                budget -= size;
+            }
+        }
+    }
+}
+
+//
+// R_PrefetchSprite
+//
+void R_PrefetchSprite(int sprite)
+{
+    int i;
+    int k;
+    spriteframe_t *sf;
+
+    for (i = 0; i < sprites[sprite].numframes; i++)
+    {
+        sf = &sprites[sprite].spriteframes[i];
+
+        for (k = 0; k < 8; k++)
+        {
+            if (k && sf->lump[k] == sf->lump[k - 1])
+                continue;
+
+            if (!spritefast[sf->lump[k]])
+                W_Prefetch(firstspritelump + sf->lump[k]);
+        }
+    }
+}
+
+//
+// R_PrefetchTexture
+//
+void R_PrefetchTexture(int tex)
+{
+    int i;
+    texture_t *texture;
+
+    tex = texturetranslation[tex];
+
+    if (!tex || texturecomposite[tex])
+        return;
+
+    texture = textures[tex];
+
+    for (i = 0; i < texture->patchcount; i++)
+        W_Prefetch(texture->patches[i].patch);
+}
+
+//
+// R_PrefetchSector
+// Queues the walls and flats around the sector
+//  the player is in, when that changes.
+//
+void R_PrefetchSector(sector_t *sec)
+{
+    static sector_t *lastsector;
+    int i;
+    line_t *line;
+    side_t *side;
+    sector_t *other;
+
+    if (sec == lastsector)
+        return;
+
+    lastsector = sec;
+
+    for (i = 0; i < sec->linecount; i++)
+    {
+        line = sec->lines[i];
+
+        side = &sides[line->sidenum[0]];
+        R_PrefetchTexture(side->toptexture);
+        R_PrefetchTexture(side->midtexture);
+        R_PrefetchTexture(side->bottomtexture);
+
+        if (line->sidenum[1] == -1)
+            continue;
+
+        side = &sides[line->sidenum[1]];
+        R_PrefetchTexture(side->toptexture);
+        R_PrefetchTexture(side->midtexture);
+        R_PrefetchTexture(side->bottomtexture);
+
+        other = line->frontsector == sec ? line->backsector : line->frontsector;
+        W_Prefetch(firstflat + flattranslation[other->floorpic]);
+        W_Prefetch(firstflat + flattranslation[other->ceilingpic]);
+    }
+}
+
 //
 // R_PrecacheLevel
 // Preloads all relevant graphics for the level.
@@ -723,6 +1601,8 @@ void R_PrecacheLevel(void)
     int j;
     int k;
     int lump;
+    int numlist;
+    int *lumps;
 
     texture_t *texture;
     thinker_t *th;
@@ -731,7 +1611,7 @@ void R_PrecacheLevel(void)
     if (demoplayback && !timingdemo)
         return;
 
-    // Precache flats.
+    // Find the flats.
     flatpresent = alloca(numflats);
     memset(flatpresent, 0, numflats);
 
@@ -741,19 +1621,7 @@ void R_PrecacheLevel(void)
         flatpresent[sectors[i].ceilingpic] = 1;
     }
 
-    flatmemory = 0;
-
-    for (i = 0; i < numflats; i++)
-    {
-        if (flatpresent[i])
-        {
-            lump = firstflat + i;
-            flatmemory += lumpinfo[lump].size;
-            W_CacheLumpNum(lump, PU_CACHE);
-        }
-    }
-
-    // Precache textures.
+    // Find the textures.
     texturepresent = alloca(numtextures);
     memset(texturepresent, 0, numtextures);
 
@@ -772,6 +1640,92 @@ void R_PrecacheLevel(void)
     //  name.
     texturepresent[skytexture] = 1;
 
+    // Find the sprites.
+    spritepresent = alloca(numsprites);
+    memset(spritepresent, 0, numsprites);
+
+    for (th = thinkercap.next; th != &thinkercap; th = th->next)
+    {
+        if (th->function.acp1 == (actionf_p1)P_MobjThinker)
+            spritepresent[((mobj_t *)th)->sprite] = 1;
+    }
+
+    // Read all the lumps in file order first,
+    //  the rest is built from the cache.
+    numlist = 0;
+
+    for (i = 0; i < numflats; i++)
+        numlist += flatpresent[i];
+
+    for (i = 0; i < numtextures; i++)
+    {
+        if (texturepresent[i])
+            numlist += textures[i]->patchcount;
+    }
+
+    for (i = 0; i < numsprites; i++)
+    {
+        if (spritepresent[i])
+            numlist += sprites[i].numframes * 8;
+    }
+
+    lumps = Z_Malloc(numlist * sizeof(*lumps), PU_STATIC, NULL);
+    numlist = 0;
+
+    for (i = 0; i < numflats; i++)
+    {
+        if (flatpresent[i])
+            lumps[numlist++] = firstflat + i;
+    }
+
+    for (i = 0; i < numtextures; i++)
+    {
+        if (!texturepresent[i])
+            continue;
+
+        texture = textures[i];
+
+        for (j = 0; j < texture->patchcount; j++)
+            lumps[numlist++] = texture->patches[j].patch;
+    }
+
+    for (i = 0; i < numsprites; i++)
+    {
+        if (!spritepresent[i])
+            continue;
+
+        for (j = 0; j < sprites[i].numframes; j++)
+        {
+            sf = &sprites[i].spriteframes[j];
+            for (k = 0; k < 8; k++)
+            {
+                if (!spritefast[sf->lump[k]])
+                    lumps[numlist++] = firstspritelump + sf->lump[k];
+            }
+        }
+    }
+
+    W_CacheLumpList(lumps, numlist, PU_CACHE);
+    Z_Free(lumps);
+
+    // Precache flats.
+    flatmemory = 0;
+
+    for (i = 0; i < numflats; i++)
+    {
+        if (flatpresent[i])
+        {
+            lump = firstflat + i;
+            flatmemory += lumpinfo[lump].size;
+
+            if (tiledFlats)
+                R_CacheTiledFlat(i, PU_CACHE);
+            else
+                W_CacheLumpNum(lump, PU_CACHE);
+        }
+    }
+
+    // Precache textures.
     for (i = 0; i < numtextures; i++)
     {
         if (!texturepresent[i])
@@ -790,15 +1744,6 @@ void R_PrecacheLevel(void)
     }
 
     // Precache sprites.
-    spritepresent = alloca(numsprites);
-    memset(spritepresent, 0, numsprites);
-
-    for (th = thinkercap.next; th != &thinkercap; th = th->next)
-    {
-        if (th->function.acp1 == (actionf_p1)P_MobjThinker)
-            spritepresent[((mobj_t *)th)->sprite] = 1;
-    }
-
     for (i = 0; i < numsprites; i++)
     {
         if (!spritepresent[i])
@@ -809,9 +1754,11 @@ void R_PrecacheLevel(void)
             sf = &sprites[i].spriteframes[j];
             for (k = 0; k < 8; k++)
             {
-                lump = firstspritelump + sf->lump[k];
-                W_CacheLumpNum(lump, PU_CACHE);
+                R_CacheFastSprite(sf->lump[k]);
             }
         }
     }
+
+    if (prelitTextures)
+        R_PrecacheLit();
 }
@@ -28,10 +28,37 @@ byte *
 R_GetColumn(int tex,
             int col);
 
+// Opaque row range of each column of a masked texture.
+short *R_CacheMaskedExtents(int tex);
+
+// Pre-lit copy of a column, NULL if not cached.
+byte *
+R_GetLitColumn(int tex,
+               int col,
+               int level);
+
+// Flat in the -tiledflats layout.
+byte *R_CacheTiledFlat(int flat, int tag);
+
+// Sprite lump in the fast patch format.
+fastpatch_t *R_CacheFastSprite(int lump);
+
 // I/O, setting up the stuff.
 void R_InitData(void);
 void R_PrecacheLevel(void);
 
+// Startup tables saved between runs, set while
+//  they are read back.
+extern byte *indexcache;
+
+void R_OpenIndexCache(void);
+void R_ReadIndex(void *dest, int size);
+void R_CloseIndexCache(void);
+
+// Queue graphics that will probably be needed soon.
+void R_PrefetchSprite(int sprite);
+void R_PrefetchSector(sector_t *sec);
+
 // Retrieval.
 // Floor/ceiling opaque texture tiles,
 // lookup by name. For animation?
@@ -35,6 +35,7 @@
 #define SIL_TOP 2
 #define SIL_BOTH 3
 
+// Initial drawseg count, grown as needed.
 #define MAXDRAWSEGS 256
 
 //
@@ -297,6 +298,15 @@ typedef struct drawseg_s
     short *sprbottomclip;
     short *maskedtexturecol;
 
+    // Masked midtexture setup, filled in once
+    //  by R_StoreWallRange.
+    int maskedtexnum;
+    fixed_t maskedtexturemid;
+    lighttable_t **maskedlights;
+
+    // Masked columns not drawn yet.
+    int maskedleft;
+
 } drawseg_t;
 
 // Patches.
@@ -314,6 +324,38 @@ typedef struct
     // the [0] is &columnofs[width]
 } patch_t;
 
+//
+// Fast patches.
+// Sprites are converted to this on first use.
+// Posts that touch are merged (up to 128 texels, the
+//  column drawers wrap there), and every column knows
+//  its post count and the texel rows it covers, so
+//  transparent or clipped columns are skipped quickly.
+// Everything is an offset from the start of the
+//  fast patch.
+//
+typedef struct
+{
+    short topdelta;
+    short length;
+    int data; // texels
+} fastpost_t;
+
+typedef struct
+{
+    unsigned short firstpost;
+    unsigned short numposts; // 0 = transparent column
+    short top;               // first opaque row
+    short bottom;            // one past the last opaque row
+} fastcolumn_t;
+
+typedef struct
+{
+    int width;
+    int posts; // offset of fastpost_t[]
+    fastcolumn_t columns[1];
+} fastpatch_t;
+
 // A vissprite_t is a thing
 //  that will be drawn during a refresh.
 // I.e. a sprite object that is partly visible.
@@ -351,6 +393,9 @@ typedef struct vissprite_s
 
     int mobjflags;
 
+    // stable id, to seed the sort with the last frame
+    mobj_t *mobj;
+
 } vissprite_t;
 
 //
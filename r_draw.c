@@ -19,6 +19,7 @@
 //
 
 #include <conio.h>
+#include <string.h>
 #include "doomdef.h"
 
 #include "i_system.h"
@@ -160,6 +161,83 @@ void R_DrawSkyFlatPotato(void)
     } while (count--);
 }
 
+//
+// Sky strip drawers.
+// dc_source is a column of the sky strip, already
+//  scaled for the view and lit, so it is a plain copy.
+//
+void R_DrawSkyStrip(void)
+{
+    register int count;
+    register byte *dest;
+    register byte *source;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    outp(SC_INDEX + 1, 1 << (dc_x & 3));
+
+    dest = destview + Mul80(dc_yl) + (dc_x >> 2);
+    source = dc_source + dc_yl;
+
+    do
+    {
+        *dest = *source++;
+        dest += SCREENWIDTH / 4;
+    } while (count--);
+}
+
+void R_DrawSkyStripLow(void)
+{
+    register int count;
+    register byte *dest;
+    register byte *source;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    if (dc_x & 1)
+        outp(SC_INDEX + 1, 12);
+    else
+        outp(SC_INDEX + 1, 3);
+
+    dest = destview + Mul80(dc_yl) + (dc_x >> 1);
+    source = dc_source + dc_yl;
+
+    do
+    {
+        *dest = *source++;
+        dest += SCREENWIDTH / 4;
+    } while (count--);
+}
+
+void R_DrawSkyStripPotato(void)
+{
+    register int count;
+    register byte *dest;
+    register byte *source;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    outp(SC_INDEX + 1, 15);
+
+    dest = destview + Mul80(dc_yl) + dc_x;
+    source = dc_source + dc_yl;
+
+    do
+    {
+        *dest = *source++;
+        dest += SCREENWIDTH / 4;
+    } while (count--);
+}
+
 void R_DrawSpanPotato(void)
 {
     int spot;
@@ -274,6 +352,86 @@ void R_DrawColumnFlatPotato(void)
     } while (count--);
 }
 
+//
+// Unscaled column drawers.
+// dc_source holds one texel per screen row,
+//  starting at dc_yl.
+//
+void R_DrawColumnUnscaled(void)
+{
+    int count;
+    byte *dest;
+    byte *source;
+
+    count = dc_yh - dc_yl;
+
+    // Zero length, column does not exceed a pixel.
+    if (count < 0)
+        return;
+
+    outp(SC_INDEX + 1, 1 << (dc_x & 3));
+
+    dest = destview + Mul80(dc_yl) + (dc_x >> 2);
+    source = dc_source;
+
+    do
+    {
+        *dest = dc_colormap[*source++];
+        dest += SCREENWIDTH / 4;
+    } while (count--);
+}
+
+void R_DrawColumnUnscaledLow(void)
+{
+    int count;
+    byte *dest;
+    byte *source;
+
+    count = dc_yh - dc_yl;
+
+    // Zero length.
+    if (count < 0)
+        return;
+
+    if (dc_x & 1)
+        outp(SC_INDEX + 1, 12);
+    else
+        outp(SC_INDEX + 1, 3);
+
+    dest = destview + Mul80(dc_yl) + (dc_x >> 1);
+    source = dc_source;
+
+    do
+    {
+        *dest = dc_colormap[*source++];
+        dest += SCREENWIDTH / 4;
+    } while (count--);
+}
+
+void R_DrawColumnUnscaledPotato(void)
+{
+    int count;
+    byte *dest;
+    byte *source;
+
+    count = dc_yh - dc_yl;
+
+    // Zero length, column does not exceed a pixel.
+    if (count < 0)
+        return;
+
+    outp(SC_INDEX + 1, 15);
+
+    dest = destview + Mul80(dc_yl) + dc_x;
+    source = dc_source;
+
+    do
+    {
+        *dest = dc_colormap[*source++];
+        dest += SCREENWIDTH / 4;
+    } while (count--);
+}
+
 //
 // Spectre/Invisibility.
 //
@@ -794,6 +952,542 @@ void R_DrawSpanFlatPotato(void)
     } while (countp--);
 }
 
+//
+// Tiled span drawers.
+// Used with -tiledflats, R_DrawSpanTiled and
+//  R_DrawSpanTiledLow are in planar.asm.
+// u and v hold the integer part of the texture
+//  coordinate on every other bit from bit 20, u on the
+//  even bits and v on the odd ones, and the fraction
+//  below. The bits of the other coordinate are kept set,
+//  so a step carries straight through them, and
+//  (u & v) >> 20 is the texel in the tiled flat.
+//
+#define TILEUGAPS 0xaaa00000
+#define TILEVGAPS 0x55500000
+
+#define TiledU(frac) (((unsigned)flatspotx[((frac) >> 16) & 63] << 20) | (((frac) & 0xffff) << 4))
+#define TiledV(frac) (((unsigned)flatspoty[((frac) >> 16) & 63] << 20) | (((frac) & 0xffff) << 4))
+
+void R_DrawSpanTiledPotato(void)
+{
+    int countp;
+    unsigned u;
+    unsigned v;
+    unsigned ustep;
+    unsigned vstep;
+    byte *dest;
+
+    countp = ds_x2 - ds_x1;
+
+    if (countp < 0)
+        return;
+
+    dest = destview + Mul80(ds_y) + ds_x1;
+    outp(SC_INDEX + 1, 15);
+
+    u = TiledU(ds_xfrac) | TILEUGAPS;
+    v = TiledV(ds_yfrac) | TILEVGAPS;
+    ustep = TiledU(ds_xstep);
+    vstep = TiledV(ds_ystep);
+
+    do
+    {
+        *dest++ = ds_colormap[ds_source[(u & v) >> 20]];
+        u = (u + ustep) | TILEUGAPS;
+        v = (v + vstep) | TILEVGAPS;
+    } while (countp--);
+}
+
+void R_DrawSpanTiledLitPotato(void)
+{
+    int countp;
+    unsigned u;
+    unsigned v;
+    unsigned ustep;
+    unsigned vstep;
+    byte *dest;
+
+    countp = ds_x2 - ds_x1;
+
+    if (countp < 0)
+        return;
+
+    dest = destview + Mul80(ds_y) + ds_x1;
+    outp(SC_INDEX + 1, 15);
+
+    u = TiledU(ds_xfrac) | TILEUGAPS;
+    v = TiledV(ds_yfrac) | TILEVGAPS;
+    ustep = TiledU(ds_xstep);
+    vstep = TiledV(ds_ystep);
+
+    do
+    {
+        *dest++ = ds_source[(u & v) >> 20];
+        u = (u + ustep) | TILEUGAPS;
+        v = (v + vstep) | TILEVGAPS;
+    } while (countp--);
+}
+
+//
+// Pre-lit span drawers.
+// Same as above, the flat already has the
+//  light level applied. R_DrawSpanLit is in planar.asm.
+//
+void R_DrawSpanLitLow(void)
+{
+    int spot;
+    int plane;
+    int x;
+    int countp;
+    fixed_t xfrac;
+    fixed_t yfrac;
+    fixed_t xstep;
+    fixed_t ystep;
+    byte *origin;
+    byte *dest;
+
+    if (ds_x2 < ds_x1)
+        return;
+
+    origin = destview + Mul80(ds_y);
+
+    xstep = ds_xstep * 2;
+    ystep = ds_ystep * 2;
+
+    for (plane = 0; plane < 2; plane++)
+    {
+        x = ds_x1 + plane;
+
+        if (x > ds_x2)
+            break;
+
+        countp = (ds_x2 - x) >> 1;
+
+        if (x & 1)
+            outp(SC_INDEX + 1, 12);
+        else
+            outp(SC_INDEX + 1, 3);
+
+        dest = origin + (x >> 1);
+        xfrac = ds_xfrac + ds_xstep * plane;
+        yfrac = ds_yfrac + ds_ystep * plane;
+
+        do
+        {
+            spot = ((yfrac >> (16 - 6)) & (63 * 64)) + ((xfrac >> 16) & 63);
+            *dest++ = ds_source[spot];
+            xfrac += xstep;
+            yfrac += ystep;
+        } while (countp--);
+    }
+}
+
+void R_DrawSpanLitPotato(void)
+{
+    int spot;
+    int countp;
+    fixed_t xfrac;
+    fixed_t yfrac;
+    byte *dest;
+
+    countp = ds_x2 - ds_x1;
+
+    if (countp < 0)
+        return;
+
+    dest = destview + Mul80(ds_y) + ds_x1;
+    outp(SC_INDEX + 1, 15);
+
+    xfrac = ds_xfrac;
+    yfrac = ds_yfrac;
+
+    do
+    {
+        spot = ((yfrac >> (16 - 6)) & (63 * 64)) + ((xfrac >> 16) & 63);
+        *dest++ = ds_source[spot];
+        xfrac += ds_xstep;
+        yfrac += ds_ystep;
+    } while (countp--);
+}
+
+//
+// LINEAR VIEW
+// With -linear the view is drawn into a buffer in RAM,
+//  one byte per view pixel and SCREENWIDTH bytes per row,
+//  so the drawers never touch the VGA ports. At low and
+//  potato detail only the left part of each row is used,
+//  R_BlitLinearView widens the pixels on the way out.
+//
+byte *linearview;
+
+void R_DrawColumnLinear(void)
+{
+    int count;
+    byte *dest;
+    fixed_t frac;
+    fixed_t fracstep;
+
+    count = dc_yh - dc_yl;
+
+    // Zero length, column does not exceed a pixel.
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(dc_yl) + dc_x;
+
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl - centery) * fracstep;
+
+    do
+    {
+        *dest = dc_colormap[dc_source[(frac >> FRACBITS) & 127]];
+        dest += SCREENWIDTH;
+        frac += fracstep;
+    } while (count--);
+}
+
+void R_DrawColumnLitLinear(void)
+{
+    int count;
+    byte *dest;
+    fixed_t frac;
+    fixed_t fracstep;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(dc_yl) + dc_x;
+
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl - centery) * fracstep;
+
+    do
+    {
+        *dest = dc_source[(frac >> FRACBITS) & 127];
+        dest += SCREENWIDTH;
+        frac += fracstep;
+    } while (count--);
+}
+
+void R_DrawColumnUnscaledLinear(void)
+{
+    int count;
+    byte *dest;
+    byte *source;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(dc_yl) + dc_x;
+    source = dc_source;
+
+    do
+    {
+        *dest = dc_colormap[*source++];
+        dest += SCREENWIDTH;
+    } while (count--);
+}
+
+void R_DrawColumnFlatLinear(void)
+{
+    int count;
+    byte *dest;
+    lighttable_t color;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    color = dc_colormap[dc_source[0]];
+    dest = linearview + Mul320(dc_yl) + dc_x;
+
+    do
+    {
+        *dest = color;
+        dest += SCREENWIDTH;
+    } while (count--);
+}
+
+void R_DrawSkyFlatLinear(void)
+{
+    int count;
+    byte *dest;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(dc_yl) + dc_x;
+
+    do
+    {
+        *dest = 220;
+        dest += SCREENWIDTH;
+    } while (count--);
+}
+
+void R_DrawSkyStripLinear(void)
+{
+    int count;
+    byte *dest;
+    byte *source;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(dc_yl) + dc_x;
+    source = dc_source + dc_yl;
+
+    do
+    {
+        *dest = *source++;
+        dest += SCREENWIDTH;
+    } while (count--);
+}
+
+void R_DrawFuzzColumnLinear(void)
+{
+    int count;
+    byte *dest;
+
+    // Adjust borders. Low...
+    if (!dc_yl)
+        dc_yl = 1;
+
+    // .. and high.
+    if (dc_yh == viewheight - 1)
+        dc_yh = viewheight - 2;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(dc_yl) + dc_x;
+
+    // fuzzoffset is in planar rows.
+    do
+    {
+        *dest = colormaps[6 * 256 + dest[fuzzoffset[fuzzpos] * 4]];
+
+        if (++fuzzpos == FUZZTABLE)
+            fuzzpos = 0;
+
+        dest += SCREENWIDTH;
+    } while (count--);
+}
+
+void R_DrawFuzzColumnFastLinear(void)
+{
+    int count;
+    byte *dest;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(dc_yl) + dc_x;
+
+    do
+    {
+        *dest = colormaps[6 * 256 + *dest];
+        dest += SCREENWIDTH;
+    } while (count--);
+}
+
+void R_DrawFuzzColumnSaturnLinear(void)
+{
+    int count;
+    byte *dest;
+    fixed_t frac;
+    fixed_t fracstep;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(dc_yl) + dc_x;
+
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl - centery) * fracstep;
+
+    // Every other pixel, checkered across columns.
+    if ((dc_yl + dc_x) & 1)
+    {
+        if (!count--)
+            return;
+
+        dest += SCREENWIDTH;
+        frac += fracstep;
+    }
+
+    count >>= 1;
+    fracstep *= 2;
+
+    do
+    {
+        *dest = dc_colormap[dc_source[frac >> FRACBITS]];
+        dest += SCREENWIDTH * 2;
+        frac += fracstep;
+    } while (count--);
+}
+
+void R_DrawSpanLinear(void)
+{
+    int spot;
+    int count;
+    fixed_t xfrac;
+    fixed_t yfrac;
+    byte *dest;
+
+    count = ds_x2 - ds_x1;
+
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(ds_y) + ds_x1;
+
+    xfrac = ds_xfrac;
+    yfrac = ds_yfrac;
+
+    do
+    {
+        spot = ((yfrac >> (16 - 6)) & (63 * 64)) + ((xfrac >> 16) & 63);
+        *dest++ = ds_colormap[ds_source[spot]];
+        xfrac += ds_xstep;
+        yfrac += ds_ystep;
+    } while (count--);
+}
+
+void R_DrawSpanLitLinear(void)
+{
+    int spot;
+    int count;
+    fixed_t xfrac;
+    fixed_t yfrac;
+    byte *dest;
+
+    count = ds_x2 - ds_x1;
+
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(ds_y) + ds_x1;
+
+    xfrac = ds_xfrac;
+    yfrac = ds_yfrac;
+
+    do
+    {
+        spot = ((yfrac >> (16 - 6)) & (63 * 64)) + ((xfrac >> 16) & 63);
+        *dest++ = ds_source[spot];
+        xfrac += ds_xstep;
+        yfrac += ds_ystep;
+    } while (count--);
+}
+
+// Same as the tiled span drawers above.
+void R_DrawSpanTiledLinear(void)
+{
+    int count;
+    unsigned u;
+    unsigned v;
+    unsigned ustep;
+    unsigned vstep;
+    byte *dest;
+
+    count = ds_x2 - ds_x1;
+
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(ds_y) + ds_x1;
+
+    u = TiledU(ds_xfrac) | TILEUGAPS;
+    v = TiledV(ds_yfrac) | TILEVGAPS;
+    ustep = TiledU(ds_xstep);
+    vstep = TiledV(ds_ystep);
+
+    do
+    {
+        *dest++ = ds_colormap[ds_source[(u & v) >> 20]];
+        u = (u + ustep) | TILEUGAPS;
+        v = (v + vstep) | TILEVGAPS;
+    } while (count--);
+}
+
+void R_DrawSpanTiledLitLinear(void)
+{
+    int count;
+    unsigned u;
+    unsigned v;
+    unsigned ustep;
+    unsigned vstep;
+    byte *dest;
+
+    count = ds_x2 - ds_x1;
+
+    if (count < 0)
+        return;
+
+    dest = linearview + Mul320(ds_y) + ds_x1;
+
+    u = TiledU(ds_xfrac) | TILEUGAPS;
+    v = TiledV(ds_yfrac) | TILEVGAPS;
+    ustep = TiledU(ds_xstep);
+    vstep = TiledV(ds_ystep);
+
+    do
+    {
+        *dest++ = ds_source[(u & v) >> 20];
+        u = (u + ustep) | TILEUGAPS;
+        v = (v + vstep) | TILEVGAPS;
+    } while (count--);
+}
+
+void R_DrawSpanFlatLinear(void)
+{
+    if (ds_x2 < ds_x1)
+        return;
+
+    memset(linearview + Mul320(ds_y) + ds_x1, ds_colormap[ds_source[0]], ds_x2 - ds_x1 + 1);
+}
+
+//
+// R_BlitLinearView
+// Copies the finished linear view to the page at dest
+//  (destview). With planesize set, dest is instead a
+//  page kept in RAM, its four planes planesize apart.
+//
+void R_BlitLinearView(byte *dest, int planesize)
+{
+    int plane;
+
+    for (plane = 0; plane < 4; plane++)
+    {
+        if (planesize)
+        {
+            R_ConvertLinearPlane(dest + plane * planesize, plane);
+        }
+        else
+        {
+            outp(SC_INDEX + 1, 1 << plane);
+            R_ConvertLinearPlane(dest, plane);
+        }
+    }
+}
+
 //
 // R_InitBuffer
 // Creats lookup tables that avoid
@@ -820,6 +1514,9 @@ void R_InitBuffer(int width,
         viewwindowy = 0;
     else
         viewwindowy = (SCREENHEIGHT - SBARHEIGHT - height) >> 1;
+
+    if (linearView && !linearview)
+        linearview = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, 0);
 }
 
 //
@@ -46,10 +46,47 @@ void R_DrawFuzzColumnFast(void);
 void R_DrawColumnPotato(void);
 void R_DrawSkyFlatPotato(void);
 
+void R_DrawSkyStrip(void);
+void R_DrawSkyStripLow(void);
+void R_DrawSkyStripPotato(void);
+
 void R_DrawColumnFlat(void);
 void R_DrawColumnFlatLow(void);
 void R_DrawColumnFlatPotato(void);
 
+// One texel per row, no scaling.
+void R_DrawColumnUnscaled(void);
+void R_DrawColumnUnscaledLow(void);
+void R_DrawColumnUnscaledPotato(void);
+
+// Pre-lit sources, no colormap.
+void R_DrawColumnLit(void);
+void R_DrawColumnLitLow(void);
+void R_DrawColumnLitPotato(void);
+
+// -linear drawers, into a buffer in RAM.
+extern byte *linearview;
+
+void R_DrawColumnLinear(void);
+void R_DrawColumnLitLinear(void);
+void R_DrawColumnUnscaledLinear(void);
+void R_DrawColumnFlatLinear(void);
+void R_DrawSkyFlatLinear(void);
+void R_DrawSkyStripLinear(void);
+void R_DrawFuzzColumnLinear(void);
+void R_DrawFuzzColumnFastLinear(void);
+void R_DrawFuzzColumnSaturnLinear(void);
+
+void R_DrawSpanLinear(void);
+void R_DrawSpanLitLinear(void);
+void R_DrawSpanFlatLinear(void);
+void R_DrawSpanTiledLinear(void);
+void R_DrawSpanTiledLitLinear(void);
+
+// Linear view to a VGA page, or a page in RAM.
+void R_ConvertLinearPlane(byte *dest, int plane);
+void R_BlitLinearView(byte *dest, int planesize);
+
 void R_VideoErase(unsigned ofs,
                   int count);
 
@@ -79,6 +116,19 @@ void R_DrawSpanFlatLow(void);
 void R_DrawSpanPotato(void);
 void R_DrawSpanFlatPotato(void);
 
+// Flats in the -tiledflats layout.
+void R_DrawSpanTiled(void);
+void R_DrawSpanTiledLow(void);
+void R_DrawSpanTiledPotato(void);
+
+void R_DrawSpanLit(void);
+void R_DrawSpanLitLow(void);
+void R_DrawSpanLitPotato(void);
+
+void R_DrawSpanTiledLit(void);
+void R_DrawSpanTiledLitLow(void);
+void R_DrawSpanTiledLitPotato(void);
+
 void R_InitBuffer(int width,
                   int height);
 
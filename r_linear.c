@@ -0,0 +1,59 @@
+//
+// Copyright (C) 1993-1996 Id Software, Inc.
+// Copyright (C) 2016-2017 Alexey Khokholov (Nuke.YKT)
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Conversion of the -linear view to VGA planes.
+//	Kept apart from r_draw.c so it builds without the
+//	DOS headers, tools/lineartest.c checks it on a host.
+//
+
+#include "doomdef.h"
+
+#include "r_local.h"
+
+//
+// R_ConvertLinearPlane
+// Gathers one plane of the view from the linear buffer,
+//  16 pixels per pass, into dest laid out like a plane
+//  of a VGA page. No port I/O here, so dest can just as
+//  well be a plane kept in RAM.
+//
+void R_ConvertLinearPlane(byte *dest, int plane)
+{
+    byte *source;
+    byte *s;
+    unsigned int *d;
+    int step;
+    int count;
+    int y;
+
+    step = 4 >> detailshift;
+    source = linearview + (plane >> detailshift);
+
+    for (y = 0; y < viewheight; y++)
+    {
+        s = source;
+        d = (unsigned int *)dest;
+        count = scaledviewwidth / 16;
+
+        do
+        {
+            *d++ = s[0] | (s[step] << 8) | (s[step * 2] << 16) | (s[step * 3] << 24);
+            s += step * 4;
+        } while (--count);
+
+        source += SCREENWIDTH;
+        dest += SCREENWIDTH / 4;
+    }
+}
@@ -26,6 +26,7 @@
 #include "d_net.h"
 
 #include "m_misc.h"
+#include "z_zone.h"
 
 #include "r_local.h"
 #include "r_sky.h"
@@ -99,6 +100,9 @@ void (*fuzzcolfunc)(void);
 void (*transcolfunc)(void);
 void (*spanfunc)(void);
 void (*skyfunc)(void);
+void (*unscaledcolfunc)(void);
+void (*litcolfunc)(void);
+void (*litspanfunc)(void);
 
 int R_PointOnSegSide(fixed_t x,
                      fixed_t y,
@@ -636,8 +640,6 @@ void R_InitTextureMapping(void)
 // Only inits the zlight table,
 //  because the scalelight table changes with view size.
 //
-#define DISTMAP 2
-
 void R_InitLightTables(void)
 {
     int i;
@@ -739,43 +741,70 @@ void R_ExecuteSetViewSize(void)
     {
     case 0:
         colfunc = basecolfunc = R_DrawColumn;
+        litcolfunc = R_DrawColumnLit;
+        unscaledcolfunc = R_DrawColumnUnscaled;
+
+        if (tiledFlats)
+            litspanfunc = R_DrawSpanTiledLit;
+        else
+            litspanfunc = R_DrawSpanLit;
 
         if (untexturedSurfaces)
             spanfunc = R_DrawSpanFlat;
+        else if (tiledFlats)
+            spanfunc = R_DrawSpanTiled;
         else
             spanfunc = R_DrawSpan;
 
         if (flatSky)
             skyfunc = R_DrawSkyFlat;
         else
-            skyfunc = R_DrawColumn;
+            skyfunc = R_DrawSkyStrip;
         break;
     case 1:
         colfunc = basecolfunc = R_DrawColumnLow;
+        litcolfunc = R_DrawColumnLitLow;
+        unscaledcolfunc = R_DrawColumnUnscaledLow;
+
+        if (tiledFlats)
+            litspanfunc = R_DrawSpanTiledLitLow;
+        else
+            litspanfunc = R_DrawSpanLitLow;
 
         if (untexturedSurfaces)
             spanfunc = R_DrawSpanFlatLow;
+        else if (tiledFlats)
+            spanfunc = R_DrawSpanTiledLow;
         else
             spanfunc = R_DrawSpanLow;
 
         if (flatSky)
             skyfunc = R_DrawSkyFlatLow;
         else
-            skyfunc = R_DrawColumnLow;
+            skyfunc = R_DrawSkyStripLow;
 
         break;
     case 2:
         colfunc = basecolfunc = R_DrawColumnPotato;
+        litcolfunc = R_DrawColumnLitPotato;
+        unscaledcolfunc = R_DrawColumnUnscaledPotato;
+
+        if (tiledFlats)
+            litspanfunc = R_DrawSpanTiledLitPotato;
+        else
+            litspanfunc = R_DrawSpanLitPotato;
 
         if (untexturedSurfaces)
             spanfunc = R_DrawSpanFlatPotato;
+        else if (tiledFlats)
+            spanfunc = R_DrawSpanTiledPotato;
         else
             spanfunc = R_DrawSpanPotato;
 
         if (flatSky)
             skyfunc = R_DrawSkyFlatPotato;
         else
-            skyfunc = R_DrawColumnPotato;
+            skyfunc = R_DrawSkyStripPotato;
 
         break;
     }
@@ -787,6 +816,38 @@ void R_ExecuteSetViewSize(void)
     else
         fuzzcolfunc = R_DrawFuzzColumn;
 
+    // The linear drawers work at any detail level.
+    if (linearView)
+    {
+        colfunc = basecolfunc = R_DrawColumnLinear;
+        litcolfunc = R_DrawColumnLitLinear;
+        unscaledcolfunc = R_DrawColumnUnscaledLinear;
+
+        if (tiledFlats)
+            litspanfunc = R_DrawSpanTiledLitLinear;
+        else
+            litspanfunc = R_DrawSpanLitLinear;
+
+        if (untexturedSurfaces)
+            spanfunc = R_DrawSpanFlatLinear;
+        else if (tiledFlats)
+            spanfunc = R_DrawSpanTiledLinear;
+        else
+            spanfunc = R_DrawSpanLinear;
+
+        if (flatSky)
+            skyfunc = R_DrawSkyFlatLinear;
+        else
+            skyfunc = R_DrawSkyStripLinear;
+
+        if (flatShadows)
+            fuzzcolfunc = R_DrawFuzzColumnFastLinear;
+        else if (saturnShadows)
+            fuzzcolfunc = R_DrawFuzzColumnSaturnLinear;
+        else
+            fuzzcolfunc = R_DrawFuzzColumnLinear;
+    }
+
     R_InitBuffer(scaledviewwidth, viewheight);
 
     R_InitTextureMapping();
@@ -979,11 +1040,131 @@ void R_SetupFrame(player_t *player)
     else
         fixedcolormap = 0;
 
+    if (usePVS)
+        R_UpdatePVS(player->mo->subsector);
+
     framecount++;
     validcount++;
     destview = destscreen + Mul80(viewwindowy) + (viewwindowx >> 2);
 }
 
+//
+// FRAME ARENA
+// Work buffers whose size depends on the scene (drawsegs,
+//  wall clip lists, vissprites) are carved from an arena
+//  that is emptied at the start of every frame. When a
+//  frame runs out of room, a chunk twice the size is
+//  chained on, and the next reset folds all chunks back
+//  into one big enough for that frame.
+//
+#define ARENAINITIAL (128 * 1024)
+
+typedef struct arenachunk_s
+{
+    struct arenachunk_s *next;
+    int size;
+} arenachunk_t;
+
+arenachunk_t *arenachunks; // newest first
+byte *arenapos;
+byte *arenaend;
+
+// bytes handed out this frame, and the most in any frame
+int arenaframe;
+int arenapeak;
+
+//
+// R_ArenaAlloc
+// The memory is only valid until the next frame.
+//
+void *R_ArenaAlloc(int size)
+{
+    arenachunk_t *chunk;
+    byte *p;
+    int chunksize;
+
+    size = (size + 3) & ~3;
+
+    if (arenapos + size > arenaend)
+    {
+        chunksize = arenachunks ? arenachunks->size * 2 : ARENAINITIAL;
+
+        while (chunksize < size)
+            chunksize *= 2;
+
+        chunk = Z_Malloc(sizeof(arenachunk_t) + chunksize, PU_STATIC, 0);
+        chunk->next = arenachunks;
+        chunk->size = chunksize;
+        arenachunks = chunk;
+
+        arenapos = (byte *)(chunk + 1);
+        arenaend = arenapos + chunksize;
+    }
+
+    p = arenapos;
+    arenapos += size;
+    arenaframe += size;
+
+    return p;
+}
+
+//
+// R_ClearArena
+// Called at frame start.
+//
+void R_ClearArena(void)
+{
+    arenachunk_t *next;
+    int total;
+
+    if (arenaframe > arenapeak)
+        arenapeak = arenaframe;
+
+    arenaframe = 0;
+
+    if (!arenachunks)
+        return;
+
+    if (arenachunks->next)
+    {
+        total = 0;
+
+        for (; arenachunks; arenachunks = next)
+        {
+            next = arenachunks->next;
+            total += arenachunks->size;
+            Z_Free(arenachunks);
+        }
+
+        arenachunks = Z_Malloc(sizeof(arenachunk_t) + total, PU_STATIC, 0);
+        arenachunks->next = NULL;
+        arenachunks->size = total;
+    }
+
+    arenapos = (byte *)(arenachunks + 1);
+    arenaend = arenapos + arenachunks->size;
+}
+
+//
+// R_MarkMappedLines
+// Walks the BSP like R_RenderPlayerView, but only
+//  marks the lines that would be drawn as seen for
+//  the automap. Used while the map hides the view.
+//
+boolean markonly;
+
+void R_MarkMappedLines(player_t *player)
+{
+    R_SetupFrame(player);
+
+    R_ClearArena();
+    R_ClearClipSegs();
+
+    markonly = true;
+    R_RenderBSPNode(numnodes - 1);
+    markonly = false;
+}
+
 //
 // R_RenderView
 //
@@ -992,6 +1173,7 @@ void R_RenderPlayerView(player_t *player)
     R_SetupFrame(player);
 
     // Clear buffers.
+    R_ClearArena();
     R_ClearClipSegs();
     R_ClearDrawSegs();
     R_ClearPlanes();
@@ -1013,6 +1195,9 @@ void R_RenderPlayerView(player_t *player)
 
     R_DrawMasked();
 
+    if (linearView)
+        R_BlitLinearView(destview, 0);
+
     // Check for new console commands.
     NetUpdate();
 }
@@ -73,6 +73,8 @@ extern lighttable_t *fixedcolormap;
 // There a 0-31, i.e. 32 LUT in the COLORMAP lump.
 #define NUMCOLORMAPS 32
 
+#define DISTMAP 2
+
 // Blocky/low detail mode.
 //B remove this?
 //  0 = high, 1 = low
@@ -88,6 +90,11 @@ extern void (*fuzzcolfunc)(void);
 // No shadow effects on floors.
 extern void (*spanfunc)(void);
 extern void (*skyfunc)(void);
+// Pre-scaled weapon sprites.
+extern void (*unscaledcolfunc)(void);
+// Pre-lit textures and flats (-prelit).
+extern void (*litcolfunc)(void);
+extern void (*litspanfunc)(void);
 
 //
 // Utility functions.
@@ -122,6 +129,17 @@ R_PointInSubsector(fixed_t x,
 // Called by G_Drawer.
 void R_RenderPlayerView(player_t *player);
 
+// Called by D_Display while the automap is up.
+extern boolean markonly;
+
+void R_MarkMappedLines(player_t *player);
+
+// Per frame work memory.
+extern int arenapeak;
+
+void *R_ArenaAlloc(int size);
+void R_ClearArena(void);
+
 // Called by startup code.
 void R_Init(void);
 
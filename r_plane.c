@@ -45,9 +45,10 @@ visplane_t *floorplane;
 visplane_t *ceilingplane;
 
 // ?
-#define MAXOPENINGS SCREENWIDTH * 64
-short openings[MAXOPENINGS];
+// Clip lists of the drawsegs, carved from the frame arena.
+#define OPENINGCHUNK (SCREENWIDTH * 16)
 short *lastopening;
+short *openingsend;
 
 //
 // Clip values are the solid pixel bounding the range.
@@ -70,6 +71,10 @@ int spanstop[SCREENHEIGHT];
 lighttable_t **planezlight;
 fixed_t planeheight;
 
+// pre-lit copies of the current flat, if any
+byte **planelit;
+byte *planesource;
+
 fixed_t yslope[SCREENHEIGHT];
 fixed_t distscale[SCREENWIDTH];
 fixed_t basexscale;
@@ -152,10 +157,37 @@ void R_MapPlane(int y, int x1)
     ds_y = y;
     ds_x1 = x1;
 
+    if (planelit)
+    {
+        index = (ds_colormap - colormaps) >> 8;
+
+        if (index < NUMCOLORMAPS && planelit[index])
+        {
+            ds_source = planelit[index];
+            litspanfunc();
+            ds_source = planesource;
+            return;
+        }
+    }
+
     // high or low detail
     spanfunc();
 }
 
+//
+// R_GrowOpenings
+// Starts a new block of at least count clip
+//  list entries, the old one stays in place.
+//
+void R_GrowOpenings(int count)
+{
+    if (count < OPENINGCHUNK)
+        count = OPENINGCHUNK;
+
+    lastopening = R_ArenaAlloc(count * sizeof(*lastopening));
+    openingsend = lastopening + count;
+}
+
 //
 // R_ClearPlanes
 // At begining of frame.
@@ -187,7 +219,7 @@ void R_ClearPlanes(void)
     }
 
     lastvisplane = visplanes;
-    lastopening = openings;
+    lastopening = openingsend = NULL;
 
     if (flatSurfaces || untexturedSurfaces){
         return;
@@ -343,6 +375,10 @@ void R_DrawPlanes(void)
             //  by INVUL inverse mapping.
             dc_colormap = colormaps;
             dc_texturemid = skytexturemid;
+
+            if (!flatSky)
+                R_CheckSkyStrip();
+
             for (x = pl->minx; x <= pl->maxx; x++)
             {
                 dc_yl = pl->top[x];
@@ -355,7 +391,7 @@ void R_DrawPlanes(void)
                     if (!flatSky)
                     {
                         angle = (viewangle + xtoviewangle[x]) >> ANGLETOSKYSHIFT;
-                        dc_source = R_GetColumn(skytexture, angle);
+                        dc_source = skystrip + (angle & skystripmask) * viewheight;
                     }
 
                     skyfunc();
@@ -382,6 +418,12 @@ void R_DrawPlanes(void)
                 {
                     dc_x = x;
 
+                    if (linearView)
+                    {
+                        R_DrawColumnFlatLinear();
+                        continue;
+                    }
+
                     switch (detailshift)
                     {
                     case 0:
@@ -402,10 +444,19 @@ void R_DrawPlanes(void)
         else
         {
             // regular flat
+            if (tiledFlats)
+                ds_source = R_CacheTiledFlat(flattranslation[pl->picnum], PU_STATIC);
+            else
+                ds_source = W_CacheLumpNum(firstflat +
+                                               flattranslation[pl->picnum],
+                                           PU_STATIC);
+            planesource = ds_source;
+
+            if (flatlit && !untexturedSurfaces)
+                planelit = &flatlit[flattranslation[pl->picnum] * NUMCOLORMAPS];
+            else
+                planelit = NULL;
 
-            ds_source = W_CacheLumpNum(firstflat +
-                                           flattranslation[pl->picnum],
-                                       PU_STATIC);
             planeheight = abs(pl->height - viewz);
             light = (pl->lightlevel >> LIGHTSEGSHIFT) + extralight;
 
@@ -23,6 +23,7 @@
 
 // Visplane related.
 extern short *lastopening;
+extern short *openingsend;
 
 typedef void (*planefunction_t)(int top, int bottom);
 
@@ -37,6 +38,7 @@ extern fixed_t distscale[SCREENWIDTH];
 
 void R_InitPlanes(void);
 void R_ClearPlanes(void);
+void R_GrowOpenings(int count);
 
 void R_MapPlane(int y,
                 int x1);
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 
 #include "i_system.h"
+#include "z_zone.h"
 
 #include "doomdef.h"
 #include "doomstat.h"
@@ -80,38 +81,37 @@ short *maskedtexturecol;
 
 //
 // R_RenderMaskedSegRange
+// The lights and texture pegging were worked out
+//  by R_StoreWallRange. Columns whose opaque rows
+//  are all clipped away are skipped before anything
+//  is computed for them, and dc_iscale is stepped
+//  with a Newton iteration from the previous column
+//  instead of a division for every column.
 //
+#define RECIPROCALSTEP 16
+
 void R_RenderMaskedSegRange(drawseg_t *ds,
 							int x1,
 							int x2)
 {
 	unsigned index;
 	column_t *col;
-	int lightnum;
 	int texnum;
+	int widthmask;
+	short *extent;
+	int top;
+	int bottom;
+	int yl;
+	int yh;
+	int reseed;
 
-	// Calculate light table.
-	// Use different light tables
-	//   for horizontal / vertical / diagonal. Diagonal?
-	// OPTIMIZE: get rid of LIGHTSEGSHIFT globally
-	curline = ds->curline;
-	frontsector = curline->frontsector;
-	backsector = curline->backsector;
-	texnum = texturetranslation[curline->sidedef->midtexture];
-
-	lightnum = (frontsector->lightlevel >> LIGHTSEGSHIFT) + extralight;
-
-	if (curline->v1->y == curline->v2->y)
-		lightnum--;
-	else if (curline->v1->x == curline->v2->x)
-		lightnum++;
-
-	if (lightnum < 0)
-		walllights = scalelight[0];
-	else if (lightnum >= LIGHTLEVELS)
-		walllights = scalelight[LIGHTLEVELS - 1];
-	else
-		walllights = scalelight[lightnum];
+	texnum = ds->maskedtexnum;
+	widthmask = texturewidthmask[texnum];
+	extent = R_CacheMaskedExtents(texnum);
+
+	// R_GetColumn can allocate, which could purge
+	//  the extents while they are still used
+	Z_ChangeTag(extent, PU_STATIC);
 
 	maskedtexturecol = ds->maskedtexturecol;
 
@@ -120,53 +120,105 @@ void R_RenderMaskedSegRange(drawseg_t *ds,
 	mfloorclip = ds->sprbottomclip;
 	mceilingclip = ds->sprtopclip;
 
-	// find positioning
-	if (curline->linedef->flags & ML_DONTPEGBOTTOM)
-	{
-		dc_texturemid = frontsector->floorheight > backsector->floorheight
-							? frontsector->floorheight
-							: backsector->floorheight;
-		dc_texturemid = dc_texturemid + textureheight[texnum] - viewz;
-	}
-	else
-	{
-		dc_texturemid = frontsector->ceilingheight < backsector->ceilingheight
-							? frontsector->ceilingheight
-							: backsector->ceilingheight;
-		dc_texturemid = dc_texturemid - viewz;
-	}
-	dc_texturemid += curline->sidedef->rowoffset;
+	dc_texturemid = ds->maskedtexturemid;
 
 	if (fixedcolormap)
 		dc_colormap = fixedcolormap;
 
+	// Only step the reciprocal while the scale changes
+	//  by less than 1/64 a column.
+	reseed = 0;
+
 	// draw the columns
-	for (dc_x = x1; dc_x <= x2; dc_x++)
+	for (dc_x = x1; dc_x <= x2; dc_x++, spryscale += rw_scalestep)
 	{
-		// calculate lighting
-		if (maskedtexturecol[dc_x] != MAXSHORT)
+		if (maskedtexturecol[dc_x] == MAXSHORT)
 		{
-			if (!fixedcolormap)
-			{
-				index = spryscale >> LIGHTSCALESHIFT;
+			reseed = 0;
+			continue;
+		}
+
+		ds->maskedleft--;
+
+		sprtopscreen = centeryfrac - FixedMul(dc_texturemid, spryscale);
+
+		top = extent[(maskedtexturecol[dc_x] & widthmask) * 2];
+		bottom = extent[(maskedtexturecol[dc_x] & widthmask) * 2 + 1];
 
-				if (index >= MAXLIGHTSCALE)
-					index = MAXLIGHTSCALE - 1;
+		if (bottom != MAXSHORT)
+		{
+			yl = (sprtopscreen + spryscale * top + FRACUNIT - 1) >> FRACBITS;
+			yh = (sprtopscreen + spryscale * bottom - 1) >> FRACBITS;
+
+			if (yh >= mfloorclip[dc_x])
+				yh = mfloorclip[dc_x] - 1;
+			if (yl <= mceilingclip[dc_x])
+				yl = mceilingclip[dc_x] + 1;
 
-				dc_colormap = walllights[index];
+			if (top >= bottom || yl > yh)
+			{
+				maskedtexturecol[dc_x] = MAXSHORT;
+				reseed = 0;
+				continue;
 			}
+		}
+
+		// calculate lighting
+		if (!fixedcolormap)
+		{
+			index = spryscale >> LIGHTSCALESHIFT;
+
+			if (index >= MAXLIGHTSCALE)
+				index = MAXLIGHTSCALE - 1;
+
+			dc_colormap = ds->maskedlights[index];
+		}
 
-			sprtopscreen = centeryfrac - FixedMul(dc_texturemid, spryscale);
+		if (reseed > 0)
+		{
+			dc_iscale = FixedMul(dc_iscale, 2 * FRACUNIT - FixedMul(spryscale, dc_iscale));
+			reseed--;
+		}
+		else
+		{
 			dc_iscale = 0xffffffffu / (unsigned)spryscale;
 
-			// draw the texture
-			col = (column_t *)((byte *)R_GetColumn(texnum, maskedtexturecol[dc_x]) - 3);
+			if ((abs(rw_scalestep) << 6) < spryscale)
+				reseed = RECIPROCALSTEP - 1;
+		}
+
+		// draw the texture
+		col = (column_t *)((byte *)R_GetColumn(texnum, maskedtexturecol[dc_x]) - 3);
+
+		R_DrawMaskedColumn(col);
+		maskedtexturecol[dc_x] = MAXSHORT;
+	}
+
+	Z_ChangeTag(extent, PU_CACHE);
+}
+
+//
+// R_DrawWallColumn
+// Draws one wall tier, from the pre-lit
+//  copy of the texture if there is one.
+//
+int litlevel;
+
+void R_DrawWallColumn(int texture, int texturecolumn)
+{
+	if (texturelit)
+	{
+		dc_source = R_GetLitColumn(texture, texturecolumn, litlevel);
 
-			R_DrawMaskedColumn(col);
-			maskedtexturecol[dc_x] = MAXSHORT;
+		if (dc_source)
+		{
+			litcolfunc();
+			return;
 		}
-		spryscale += rw_scalestep;
 	}
+
+	dc_source = R_GetColumn(texture, texturecolumn);
+	colfunc();
 }
 
 //
@@ -257,6 +309,7 @@ void R_RenderSegLoop(void)
 				index = MAXLIGHTSCALE - 1;
 
 			dc_colormap = walllights[index];
+			litlevel = (dc_colormap - colormaps) >> 8;
 			dc_x = rw_x;
 			dc_iscale = 0xffffffffu / (unsigned)rw_scale;
 		}
@@ -268,8 +321,7 @@ void R_RenderSegLoop(void)
 			dc_yl = yl;
 			dc_yh = yh;
 			dc_texturemid = rw_midtexturemid;
-			dc_source = R_GetColumn(midtexture, texturecolumn);
-			colfunc();
+			R_DrawWallColumn(midtexture, texturecolumn);
 			cc_rwx = viewheight;
 			fc_rwx = -1;
 		}
@@ -290,8 +342,7 @@ void R_RenderSegLoop(void)
 					dc_yl = yl;
 					dc_yh = mid;
 					dc_texturemid = rw_toptexturemid;
-					dc_source = R_GetColumn(toptexture, texturecolumn);
-					colfunc();
+					R_DrawWallColumn(toptexture, texturecolumn);
 					cc_rwx = mid;
 				}
 				else
@@ -319,9 +370,7 @@ void R_RenderSegLoop(void)
 					dc_yl = mid;
 					dc_yh = yh;
 					dc_texturemid = rw_bottomtexturemid;
-					dc_source = R_GetColumn(bottomtexture,
-											texturecolumn);
-					colfunc();
+					R_DrawWallColumn(bottomtexture, texturecolumn);
 					fc_rwx = mid;
 				}
 				else
@@ -364,9 +413,19 @@ void R_StoreWallRange(int start,
 	fixed_t vtop;
 	int lightnum;
 
-	// don't overflow and crash
-	if (ds_p == &drawsegs[MAXDRAWSEGS])
+	// R_MarkMappedLines only wants to know it is seen.
+	if (markonly)
+	{
+		curline->linedef->flags |= ML_MAPPED;
 		return;
+	}
+
+	if (ds_p == drawsegs + maxdrawsegs)
+		R_GrowDrawSegs();
+
+	// room for the masked column and sprite clip lists
+	if (lastopening + 3 * (stop - start + 1) > openingsend)
+		R_GrowOpenings(3 * (stop - start + 1));
 
 	sidedef = curline->sidedef;
 	linedef = curline->linedef;
@@ -412,6 +471,7 @@ void R_StoreWallRange(int start,
 
 	midtexture = toptexture = bottomtexture = maskedtexture = 0;
 	ds_p->maskedtexturecol = NULL;
+	ds_p->maskedleft = 0;
 
 	if (!backsector)
 	{
@@ -557,7 +617,27 @@ void R_StoreWallRange(int start,
 			// masked midtexture
 			maskedtexture = true;
 			ds_p->maskedtexturecol = maskedtexturecol = lastopening - rw_x;
+			ds_p->maskedleft = rw_stopx - rw_x;
 			lastopening += rw_stopx - rw_x;
+
+			ds_p->maskedtexnum = texturetranslation[sidedef->midtexture];
+
+			// find positioning
+			if (linedef->flags & ML_DONTPEGBOTTOM)
+			{
+				ds_p->maskedtexturemid = frontsector->floorheight > backsector->floorheight
+											 ? frontsector->floorheight
+											 : backsector->floorheight;
+				ds_p->maskedtexturemid += textureheight[ds_p->maskedtexnum] - viewz;
+			}
+			else
+			{
+				ds_p->maskedtexturemid = frontsector->ceilingheight < backsector->ceilingheight
+											 ? frontsector->ceilingheight
+											 : backsector->ceilingheight;
+				ds_p->maskedtexturemid -= viewz;
+			}
+			ds_p->maskedtexturemid += sidedef->rowoffset;
 		}
 	}
 
@@ -602,6 +682,8 @@ void R_StoreWallRange(int start,
 			else
 				walllights = scalelight[lightnum];
 		}
+
+		ds_p->maskedlights = walllights;
 	}
 
 	// if a floor / ceiling plane is on the wrong side
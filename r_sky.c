@@ -23,7 +23,10 @@
 // Needed for FRACUNIT.
 #include "doomdef.h"
 
+#include "z_zone.h"
+
 // Needed for Flat retrieval.
+#include "r_local.h"
 #include "r_data.h"
 #include "r_sky.h"
 
@@ -43,3 +46,59 @@ void R_InitSkyMap(void)
     skyflatnum = R_FlatNumForName(SKYFLATNAME);
     skytexturemid = 100 * FRACUNIT;
 }
+
+//
+// Sky strip.
+// The sky only depends on the view angle, so it is kept
+//  composited and scaled for the view: for every column
+//  of the sky texture, viewheight rows with colormaps[0]
+//  already applied.
+// Rows wrap at 128 texels like R_DrawColumn.
+//
+byte *skystrip;
+int skystripmask;
+int skystriptexture;
+int skystripheight;
+fixed_t skystripiscale;
+
+//
+// R_CheckSkyStrip
+// Rebuilds the strip if the sky texture
+//  or the view size changed.
+//
+void R_CheckSkyStrip(void)
+{
+    fixed_t iscale;
+    fixed_t frac;
+    byte *source;
+    byte *dest;
+    int x;
+    int y;
+
+    iscale = pspriteiscale >> detailshift;
+
+    if (skystrip && skystriptexture == skytexture && skystripheight == viewheight && skystripiscale == iscale)
+        return;
+
+    if (skystrip)
+        Z_Free(skystrip);
+
+    skystriptexture = skytexture;
+    skystripheight = viewheight;
+    skystripiscale = iscale;
+    skystripmask = texturewidthmask[skytexture];
+
+    dest = Z_Malloc((skystripmask + 1) * viewheight, PU_STATIC, &skystrip);
+
+    for (x = 0; x <= skystripmask; x++)
+    {
+        source = R_GetColumn(skytexture, x);
+        frac = skytexturemid - centery * iscale;
+
+        for (y = 0; y < viewheight; y++)
+        {
+            *dest++ = colormaps[source[(frac >> FRACBITS) & 127]];
+            frac += iscale;
+        }
+    }
+}
@@ -31,4 +31,11 @@ extern int skytexturemid;
 // Called whenever the view size changes.
 void R_InitSkyMap(void);
 
+// Sky strip, one column of viewheight rows
+//  per sky texture column.
+extern byte *skystrip;
+extern int skystripmask;
+
+void R_CheckSkyStrip(void);
+
 #endif
@@ -30,6 +30,7 @@
 
 // needed for texture pegging
 extern fixed_t *textureheight;
+extern int *texturewidthmask;
 
 // needed for pre rendering (fracs)
 extern fixed_t *spritewidth;
@@ -49,6 +50,14 @@ extern int firstflat;
 extern int *flattranslation;
 extern int *texturetranslation;
 
+// texel (x, y) of a flat is at flatspotx[x] + flatspoty[y]
+extern int flatspotx[64];
+extern int flatspoty[64];
+
+// pre-lit copies, [num * NUMCOLORMAPS + level]
+extern byte **texturelit;
+extern byte **flatlit;
+
 // Sprite....
 extern int firstspritelump;
 extern int lastspritelump;
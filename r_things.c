@@ -25,6 +25,7 @@
 #include "i_system.h"
 #include "z_zone.h"
 #include "w_wad.h"
+#include "d_main.h"
 
 #include "r_local.h"
 
@@ -175,6 +176,23 @@ void R_InitSpriteDefs(char **namelist)
 
     sprites = Z_Malloc(numsprites * sizeof(*sprites), PU_STATIC, NULL);
 
+    if (indexcache)
+    {
+        for (i = 0; i < numsprites; i++)
+        {
+            R_ReadIndex(&sprites[i].numframes, sizeof(int));
+
+            if (!sprites[i].numframes)
+                continue;
+
+            sprites[i].spriteframes =
+                Z_Malloc(sprites[i].numframes * sizeof(spriteframe_t), PU_STATIC, NULL);
+            R_ReadIndex(sprites[i].spriteframes, sprites[i].numframes * sizeof(spriteframe_t));
+        }
+
+        return;
+    }
+
     start = firstspritelump - 1;
     end = lastspritelump + 1;
 
@@ -267,6 +285,27 @@ int newvissprite;
 vissprite_t **vissprite_ptrs; // killough
 size_t num_vissprite, num_vissprite_alloc, num_vissprite_ptrs;
 
+//
+// Pre-scaled weapon sprites.
+// The player weapons are always drawn at the same scale,
+//  so each frame is kept scaled for the current view size
+//  and detail as runs of screen rows.
+// Every column is a list of runs, a run is a top row and a
+//  count (shorts) followed by count texels.
+//  A top of -1 ends the column.
+// The runs assume the top of the sprite is at row 0,
+//  bobbing only moves them.
+//
+typedef struct
+{
+    fixed_t scale;
+    int detail;
+    int width;
+    int columnofs[1];
+} scaledpatch_t;
+
+scaledpatch_t **weaponscaled;
+
 //
 // R_InitSprites
 // Called at program start.
@@ -281,6 +320,13 @@ void R_InitSprites(char **namelist)
     }
 
     R_InitSpriteDefs(namelist);
+    D_Timing("R_InitSpriteDefs");
+
+    R_CloseIndexCache();
+    D_Timing("R_CloseIndexCache");
+
+    weaponscaled = Z_Malloc(numspritelumps * sizeof(*weaponscaled), PU_STATIC, 0);
+    memset(weaponscaled, 0, numspritelumps * sizeof(*weaponscaled));
 }
 
 //
@@ -289,6 +335,10 @@ void R_InitSprites(char **namelist)
 //
 void R_ClearSprites(void)
 {
+    if (!num_vissprite_alloc)
+        num_vissprite_alloc = INITIAL_SPRITES;
+
+    vissprites = R_ArenaAlloc(num_vissprite_alloc * sizeof(*vissprites));
     num_vissprite = 0; // killough
 }
 
@@ -351,18 +401,78 @@ void R_DrawMaskedColumn(column_t *column)
     dc_texturemid = basetexturemid;
 }
 
+//
+// R_DrawFastColumn
+// R_DrawMaskedColumn for fast patches.
+//
+void R_DrawFastColumn(fastpatch_t *patch,
+                      fastcolumn_t *column)
+{
+    int topscreen;
+    int bottomscreen;
+    fixed_t basetexturemid;
+    fastpost_t *post;
+    int count;
+
+    int yl, yh;
+    short mfc_x, mcc_x;
+
+    mfc_x = mfloorclip[dc_x];
+    mcc_x = mceilingclip[dc_x];
+
+    // Whole column clipped away?
+    topscreen = sprtopscreen + spryscale * column->top;
+    bottomscreen = sprtopscreen + spryscale * column->bottom;
+
+    if ((bottomscreen - 1) >> FRACBITS <= mcc_x || (topscreen + FRACUNIT - 1) >> FRACBITS >= mfc_x)
+        return;
+
+    basetexturemid = dc_texturemid;
+    post = (fastpost_t *)((byte *)patch + patch->posts) + column->firstpost;
+
+    for (count = column->numposts; count--; post++)
+    {
+        // calculate unclipped screen coordinates
+        //  for post
+        topscreen = sprtopscreen + spryscale * post->topdelta;
+        bottomscreen = topscreen + spryscale * post->length;
+
+        yl = (topscreen + FRACUNIT - 1) >> FRACBITS;
+        yh = (bottomscreen - 1) >> FRACBITS;
+
+        if (yh >= mfc_x)
+            yh = mfc_x - 1;
+        if (yl <= mcc_x)
+            yl = mcc_x + 1;
+
+        if (yh < viewheight && yl <= yh)
+        {
+            dc_source = (byte *)patch + post->data;
+            dc_texturemid = basetexturemid - (post->topdelta << FRACBITS);
+
+            dc_yh = yh;
+            dc_yl = yl;
+
+            // Drawn by either R_DrawColumn
+            //  or (SHADOW) R_DrawFuzzColumn.
+            colfunc();
+        }
+    }
+
+    dc_texturemid = basetexturemid;
+}
+
 //
 // R_DrawVisSprite
 //  mfloorclip and mceilingclip should also be set.
 //
 void R_DrawVisSprite(vissprite_t *vis)
 {
-    column_t *column;
-    int texturecolumn;
+    fastcolumn_t *column;
     fixed_t frac;
-    patch_t *patch;
+    fastpatch_t *patch;
 
-    patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    patch = R_CacheFastSprite(vis->patch);
 
     dc_colormap = vis->colormap;
 
@@ -382,10 +492,11 @@ void R_DrawVisSprite(vissprite_t *vis)
 
     for (dc_x = vis->x1; dc_x <= vis->x2; dc_x++, frac += vis->xiscale)
     {
-        texturecolumn = frac >> FRACBITS;
-        column = (column_t *)((byte *)patch +
-                              LONG(patch->columnofs[texturecolumn]));
-        R_DrawMaskedColumn(column);
+        column = &patch->columns[frac >> FRACBITS];
+
+        // Transparent columns are skipped outright.
+        if (column->numposts)
+            R_DrawFastColumn(patch, column);
     }
 
     colfunc = basecolfunc;
@@ -502,26 +613,19 @@ void R_ProjectSprite(mobj_t *thing)
 
     if (num_vissprite >= num_vissprite_alloc) // killough
     {
-        if (num_vissprite_alloc == 0)
-        {
-            num_vissprite_alloc = INITIAL_SPRITES; // Initial num sprites -> 128
-            vissprites = Z_Malloc(num_vissprite_alloc * sizeof(*vissprites), PU_STATIC, 0);
-        }
-        else
-        {
-            vissprite_t *vissprites_old;
-            size_t num_vissprite_alloc_old;
+        vissprite_t *vissprites_old;
+        size_t num_vissprite_alloc_old;
 
-            vissprites_old = vissprites;
-            num_vissprite_alloc_old = num_vissprite_alloc;
+        // The old array is left in the frame arena.
+        vissprites_old = vissprites;
+        num_vissprite_alloc_old = num_vissprite_alloc;
 
-            num_vissprite_alloc = num_vissprite_alloc * 2;
-            vissprites = Z_Malloc(num_vissprite_alloc * sizeof(*vissprites), PU_STATIC, 0);
-            memcpy(vissprites, vissprites_old, num_vissprite_alloc_old * sizeof(*vissprites));
-            Z_Free(vissprites_old);
-        }
+        num_vissprite_alloc = num_vissprite_alloc * 2;
+        vissprites = R_ArenaAlloc(num_vissprite_alloc * sizeof(*vissprites));
+        memcpy(vissprites, vissprites_old, num_vissprite_alloc_old * sizeof(*vissprites));
     }
     vis = vissprites + num_vissprite++;
+    vis->mobj = thing;
     vis->mobjflags = thing->flags;
     vis->scale = xscale << detailshift;
     vis->gx = thing->x;
@@ -611,6 +715,199 @@ void R_AddSprites(sector_t *sec)
         R_ProjectSprite(thing);
 }
 
+//
+// R_ScaleWeaponColumn
+// Writes the runs of one scaled column to dest,
+//  or just counts the bytes if dest is NULL.
+//
+int R_ScaleWeaponColumn(fastpatch_t *patch,
+                        fastcolumn_t *column,
+                        byte *dest)
+{
+    fastpost_t *post;
+    byte *source;
+    short *run;
+    int count;
+    int size;
+    int lastend;
+    int yl;
+    int yh;
+    int y;
+    int texel;
+    fixed_t scale;
+    fixed_t iscale;
+
+    scale = pspritescale << detailshift;
+    iscale = pspriteiscale >> detailshift;
+
+    post = (fastpost_t *)((byte *)patch + patch->posts) + column->firstpost;
+    run = NULL;
+    size = 0;
+    lastend = -1;
+
+    for (count = column->numposts; count--; post++)
+    {
+        yl = (scale * post->topdelta + FRACUNIT - 1) >> FRACBITS;
+        yh = (scale * (post->topdelta + post->length) - 1) >> FRACBITS;
+
+        if (yl > yh)
+            continue;
+
+        // Continue the last run if it ends right above.
+        if (yl == lastend)
+        {
+            size += yh - yl + 1;
+
+            if (dest)
+                run[1] += yh - yl + 1;
+        }
+        else
+        {
+            size += 4 + yh - yl + 1;
+
+            if (dest)
+            {
+                run = (short *)dest;
+                run[0] = yl;
+                run[1] = yh - yl + 1;
+                dest += 4;
+            }
+        }
+
+        lastend = yh + 1;
+
+        if (!dest)
+            continue;
+
+        source = (byte *)patch + post->data;
+
+        for (y = yl; y <= yh; y++)
+        {
+            texel = ((y * iscale) >> FRACBITS) - post->topdelta;
+
+            if (texel < 0)
+                texel = 0;
+
+            if (texel >= post->length)
+                texel = post->length - 1;
+
+            *dest++ = source[texel];
+        }
+    }
+
+    if (dest)
+        *(short *)dest = -1;
+
+    return size + 2;
+}
+
+//
+// R_CacheScaledWeapon
+// Returns the sprite lump scaled for the
+//  current view, scaling it if needed.
+//
+scaledpatch_t *R_CacheScaledWeapon(int lump)
+{
+    scaledpatch_t *scaled;
+    fastpatch_t *patch;
+    int width;
+    int size;
+    int x;
+
+    scaled = weaponscaled[lump];
+
+    if (scaled)
+    {
+        if (scaled->scale == pspritescale && scaled->detail == detailshift)
+        {
+            Z_Touch(scaled);
+            return scaled;
+        }
+
+        // View size changed.
+        Z_Free(scaled);
+    }
+
+    patch = R_CacheFastSprite(lump);
+    Z_ChangeTag(patch, PU_STATIC);
+
+    width = 0;
+
+    while ((width * pspriteiscale) >> FRACBITS < patch->width)
+        width++;
+
+    size = sizeof(scaledpatch_t) + (width - 1) * sizeof(int);
+
+    for (x = 0; x < width; x++)
+        size += R_ScaleWeaponColumn(patch, &patch->columns[(x * pspriteiscale) >> FRACBITS], NULL);
+
+    scaled = Z_Malloc(size, PU_CACHE, &weaponscaled[lump]);
+    scaled->scale = pspritescale;
+    scaled->detail = detailshift;
+    scaled->width = width;
+
+    size = sizeof(scaledpatch_t) + (width - 1) * sizeof(int);
+
+    for (x = 0; x < width; x++)
+    {
+        scaled->columnofs[x] = size;
+        size += R_ScaleWeaponColumn(patch,
+                                    &patch->columns[(x * pspriteiscale) >> FRACBITS],
+                                    (byte *)scaled + size);
+    }
+
+    Z_ChangeTag(patch, PU_CACHE);
+
+    return scaled;
+}
+
+//
+// R_DrawScaledWeapon
+// Clipped copy of a pre-scaled weapon,
+//  x1 is the unclipped left edge.
+//
+void R_DrawScaledWeapon(vissprite_t *vis, int x1)
+{
+    scaledpatch_t *scaled;
+    short *run;
+    int top;
+    int yl;
+    int yh;
+
+    scaled = R_CacheScaledWeapon(vis->patch);
+
+    top = (centeryfrac - FixedMul(vis->texturemid, vis->scale) + FRACUNIT / 2) >> FRACBITS;
+    dc_colormap = vis->colormap;
+
+    for (dc_x = vis->x1; dc_x <= vis->x2 && dc_x - x1 < scaled->width; dc_x++)
+    {
+        run = (short *)((byte *)scaled + scaled->columnofs[dc_x - x1]);
+
+        for (; run[0] != -1; run = (short *)((byte *)run + 4 + run[1]))
+        {
+            yl = top + run[0];
+            yh = yl + run[1] - 1;
+            dc_source = (byte *)(run + 2);
+
+            if (yl < 0)
+            {
+                dc_source -= yl;
+                yl = 0;
+            }
+
+            if (yh >= viewheight)
+                yh = viewheight - 1;
+
+            if (yl > yh)
+                continue;
+
+            dc_yl = yl;
+            dc_yh = yh;
+            unscaledcolfunc();
+        }
+    }
+}
+
 //
 // R_DrawPSprite
 //
@@ -687,7 +984,11 @@ void R_DrawPSprite(pspdef_t *psp)
         vis->colormap = spritelights[MAXLIGHTSCALE - 1];
     }
 
-    R_DrawVisSprite(vis);
+    // Shadows and flipped frames take the generic path.
+    if (vis->colormap && !flip)
+        R_DrawScaledWeapon(vis, x1);
+    else
+        R_DrawVisSprite(vis);
 }
 
 //
@@ -770,32 +1071,205 @@ static void msort(vissprite_t **s, vissprite_t **t, int n)
     }
 }
 
+//
+// Incremental sorting.
+// Sprite order barely changes from one frame to the next,
+//  so the pointers are seeded with the order the same mobjs
+//  had last frame, and an insertion sort finishes the job.
+// New sprites go at the end in BSP order.
+// If the insertion sort has to move too much, or the view
+//  jumped (teleport, big turn), msort does it all instead.
+//
+#define SORTJUMPDIST (128 * FRACUNIT)
+#define SORTJUMPANGLE ANG45
+#define SORTMAXMOVES 4
+
+mobj_t **vissprite_prev;
+int num_vissprite_prev;
+int *vissprite_hash;
+int vissprite_hashmask;
+
+fixed_t sortviewx;
+fixed_t sortviewy;
+angle_t sortviewangle;
+
+int R_VisSpriteHash(mobj_t *mobj)
+{
+    return (((unsigned)mobj >> 3) * 2654435761u >> 8) & vissprite_hashmask;
+}
+
+//
+// R_SeedVisSprites
+// Fills vissprite_ptrs in last frame's order.
+//
+void R_SeedVisSprites(void)
+{
+    int i;
+    int h;
+    int e;
+    int count;
+
+    memset(vissprite_hash, 0, (vissprite_hashmask + 1) * sizeof(*vissprite_hash));
+
+    // Hash this frame's sprites by mobj, entries are index + 1.
+    for (i = 0; i < num_vissprite; i++)
+    {
+        h = R_VisSpriteHash(vissprites[i].mobj);
+
+        while (vissprite_hash[h])
+            h = (h + 1) & vissprite_hashmask;
+
+        vissprite_hash[h] = i + 1;
+    }
+
+    // Last frame's order first, placed entries are negated.
+    count = 0;
+
+    for (i = 0; i < num_vissprite_prev; i++)
+    {
+        h = R_VisSpriteHash(vissprite_prev[i]);
+
+        while ((e = vissprite_hash[h]) != 0)
+        {
+            if (e > 0 && vissprites[e - 1].mobj == vissprite_prev[i])
+            {
+                vissprite_ptrs[count++] = vissprites + e - 1;
+                vissprite_hash[h] = -e;
+                break;
+            }
+
+            h = (h + 1) & vissprite_hashmask;
+        }
+    }
+
+    // Then the new ones.
+    for (i = 0; i < num_vissprite; i++)
+    {
+        h = R_VisSpriteHash(vissprites[i].mobj);
+
+        while ((e = vissprite_hash[h]) != 0)
+        {
+            if (e == i + 1)
+            {
+                vissprite_ptrs[count++] = vissprites + i;
+                break;
+            }
+
+            if (e == -(i + 1))
+                break;
+
+            h = (h + 1) & vissprite_hashmask;
+        }
+    }
+}
+
+//
+// R_InsertVisSprites
+// Insertion sort, same order as msort.
+// Returns false if it gave up after too many moves.
+//
+boolean R_InsertVisSprites(vissprite_t **s, int n)
+{
+    int i;
+    int j;
+    int moves;
+    vissprite_t *temp;
+
+    moves = n * SORTMAXMOVES;
+
+    for (i = 1; i < n; i++)
+    {
+        temp = s[i];
+
+        if (s[i - 1]->scale < temp->scale)
+        {
+            j = i;
+
+            do
+            {
+                s[j] = s[j - 1];
+                j--;
+            } while (j && s[j - 1]->scale < temp->scale);
+
+            s[j] = temp;
+            moves -= i - j;
+
+            if (moves < 0)
+                return false;
+        }
+    }
+
+    return true;
+}
+
 void R_SortVisSprites(void)
 {
+    int i;
+    int size;
+    boolean jumped;
+
     if (num_vissprite)
     {
-        int i = num_vissprite;
+        i = num_vissprite;
+
+        // msort uses the second half as scratch.
+        vissprite_ptrs = R_ArenaAlloc(num_vissprite * 2 * sizeof *vissprite_ptrs);
 
         // If we need to allocate more pointers for the vissprites,
         // allocate as many as were allocated for sprites -- killough
         // killough 9/22/98: allocate twice as many
-
+        // The order of the last frame has to outlive it, so
+        //  it is not kept in the frame arena.
         if (num_vissprite_ptrs < num_vissprite * 2)
         {
             if (num_vissprite_ptrs > 0)
-                Z_Free(vissprite_ptrs);
+            {
+                Z_Free(vissprite_prev);
+                Z_Free(vissprite_hash);
+            }
             num_vissprite_ptrs = num_vissprite_alloc * 2;
-            vissprite_ptrs = Z_Malloc(num_vissprite_ptrs * sizeof *vissprite_ptrs, PU_STATIC, 0);
+            vissprite_prev = Z_Malloc(num_vissprite_ptrs * sizeof *vissprite_prev, PU_STATIC, 0);
+            num_vissprite_prev = 0;
+
+            // Hash table at most half full.
+            for (size = 1; size < num_vissprite_ptrs; size <<= 1)
+                ;
+
+            vissprite_hash = Z_Malloc(size * sizeof *vissprite_hash, PU_STATIC, 0);
+            vissprite_hashmask = size - 1;
         }
 
-        while (--i >= 0)
-            vissprite_ptrs[i] = vissprites + i;
+        jumped = abs(viewx - sortviewx) > SORTJUMPDIST ||
+                 abs(viewy - sortviewy) > SORTJUMPDIST ||
+                 viewangle - sortviewangle + SORTJUMPANGLE > 2 * SORTJUMPANGLE;
+
+        if (jumped || !num_vissprite_prev)
+        {
+            while (--i >= 0)
+                vissprite_ptrs[i] = vissprites + i;
+
+            // killough 9/22/98: replace qsort with merge sort, since the keys
+            // are roughly in order to begin with, due to BSP rendering.
 
-        // killough 9/22/98: replace qsort with merge sort, since the keys
-        // are roughly in order to begin with, due to BSP rendering.
+            msort(vissprite_ptrs, vissprite_ptrs + num_vissprite, num_vissprite);
+        }
+        else
+        {
+            R_SeedVisSprites();
 
-        msort(vissprite_ptrs, vissprite_ptrs + num_vissprite, num_vissprite);
+            if (!R_InsertVisSprites(vissprite_ptrs, num_vissprite))
+                msort(vissprite_ptrs, vissprite_ptrs + num_vissprite, num_vissprite);
+        }
+
+        // Remember the order for the next frame.
+        for (i = 0; i < num_vissprite; i++)
+            vissprite_prev[i] = vissprite_ptrs[i]->mobj;
     }
+
+    num_vissprite_prev = num_vissprite;
+    sortviewx = viewx;
+    sortviewy = viewy;
+    sortviewangle = viewangle;
 }
 
 //
@@ -848,7 +1322,7 @@ void R_DrawSprite(vissprite_t *spr)
         if (scale < spr->scale || (lowscale < spr->scale && !R_PointOnSegSide(spr->gx, spr->gy, ds->curline)))
         {
             // masked mid texture?
-            if (ds->maskedtexturecol)
+            if (ds->maskedleft)
                 R_RenderMaskedSegRange(ds, r1, r2);
             // seg is behind sprite
             continue;
@@ -891,7 +1365,7 @@ void R_DrawMasked(void)
 
     // render any remaining masked mid textures
     for (ds = ds_p - 1; ds >= drawsegs; ds--)
-        if (ds->maskedtexturecol)
+        if (ds->maskedleft)
             R_RenderMaskedSegRange(ds, ds->x1, ds->x2);
 
     R_DrawPlayerSprites();
@@ -391,6 +391,25 @@ int S_getChannel(void *origin,
     return cnum;
 }
 
+//
+// S_PrefetchSound
+//
+void S_PrefetchSound(int sfx_id)
+{
+    sfxinfo_t *sfx;
+
+    if (snd_SfxDevice == snd_none || !sfx_id)
+        return;
+
+    sfx = &S_sfx[sfx_id];
+
+    if (sfx->lumpnum < 0)
+        sfx->lumpnum = I_GetSfxLumpNum(sfx);
+
+    if (!sfx->data)
+        W_Prefetch(sfx->lumpnum);
+}
+
 void S_StartSound(void *origin_p, int sfx_id)
 {
 
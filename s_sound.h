@@ -41,6 +41,9 @@ void S_Start(void);
 void S_StartSound(void *origin,
                   int sound_id);
 
+// Read the sound ahead of its first use.
+void S_PrefetchSound(int sfx_id);
+
 // Stop sound for thing at <origin>
 void S_StopSound(void *origin);
 
@@ -0,0 +1,116 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Host check of R_ConvertLinearPlane (r_linear.c).
+//	Build and run it from the tools directory:
+//	 cc -I.. -o lineartest lineartest.c ../r_linear.c
+//	 ./lineartest
+//	Every view size and detail level is converted from
+//	 a random linear view and compared, pixel by pixel,
+//	 with where the VGA planes put that screen pixel.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "doomdef.h"
+#include "r_local.h"
+
+#define PLANESIZE (SCREENWIDTH / 4 * SCREENHEIGHT)
+
+byte *linearview;
+int detailshift;
+int viewheight;
+int scaledviewwidth;
+
+byte linear[SCREENWIDTH * SCREENHEIGHT];
+byte planes[4][PLANESIZE];
+
+//
+// CheckView
+// Returns the number of wrong pixels.
+//
+int CheckView(int width, int height, int detail)
+{
+    int plane;
+    int x;
+    int y;
+    int i;
+    int wrong;
+    byte expect;
+
+    for (i = 0; i < sizeof(linear); i++)
+        linear[i] = rand();
+
+    memset(planes, 0, sizeof(planes));
+
+    linearview = linear;
+    detailshift = detail;
+    viewheight = height;
+    scaledviewwidth = width;
+
+    for (plane = 0; plane < 4; plane++)
+        R_ConvertLinearPlane(planes[plane], plane);
+
+    wrong = 0;
+
+    for (y = 0; y < SCREENHEIGHT; y++)
+    {
+        for (x = 0; x < SCREENWIDTH; x++)
+        {
+            // low and potato detail draw 2 and 4 pixels wide
+            if (x < width && y < height)
+                expect = linear[y * SCREENWIDTH + (x >> detail)];
+            else
+                expect = 0;
+
+            if (planes[x & 3][y * (SCREENWIDTH / 4) + (x >> 2)] != expect)
+                wrong++;
+        }
+    }
+
+    return wrong;
+}
+
+int main(void)
+{
+    int width;
+    int height;
+    int detail;
+    int wrong;
+    int failed;
+
+    failed = 0;
+
+    for (detail = 0; detail < 3; detail++)
+    {
+        for (width = 16; width <= SCREENWIDTH; width += 16)
+        {
+            for (height = 1; height <= SCREENHEIGHT; height += 7)
+            {
+                wrong = CheckView(width, height, detail);
+
+                if (wrong)
+                {
+                    printf("detail %d, %dx%d: %d pixels wrong\n",
+                           detail, width, height, wrong);
+                    failed++;
+                }
+            }
+        }
+    }
+
+    printf(failed ? "lineartest: FAILED\n" : "lineartest: ok\n");
+
+    return failed != 0;
+}
@@ -0,0 +1,189 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Host check of I_CopyBoxPlane (i_plane.c).
+//	Build and run it from the tools directory:
+//	 cc -I.. -o planetest planetest.c ../i_plane.c
+//	 ./planetest
+//	Boxes of every position and size are copied to the
+//	 four planes of a page and compared with the copy
+//	 I_UpdateBox made before the bands were split. The
+//	 assembler I_CopyPlane32 can't run here, so it is
+//	 replaced by a C model of planar.asm, pass for pass.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "doomdef.h"
+#include "i_ibm.h"
+
+#define PLANESIZE (SCREENWIDTH / 4 * SCREENHEIGHT)
+
+byte screen[SCREENWIDTH * SCREENHEIGHT];
+byte page[4][PLANESIZE];
+byte oldpage[4][PLANESIZE];
+
+//
+// I_CopyPlane32
+// Model of planar.asm: the loops decrement before
+//  testing, like dec/jnz.
+//
+void I_CopyPlane32(byte *dest, byte *source, int count, int height)
+{
+    int c;
+
+    do
+    {
+        c = count;
+
+        do
+        {
+            *(unsigned int *)dest = source[0] | (source[4] << 8) |
+                                    (source[8] << 16) | (source[12] << 24);
+            source += 16;
+            dest += 4;
+        } while (--c);
+
+        source += SCREENWIDTH - count * 16;
+        dest += SCREENWIDTH / 4 - count * 4;
+    } while (--height);
+}
+
+//
+// OldUpdateBox
+// I_UpdateBox before the band split, one plane at a time
+//  instead of through the map mask. The right edge is
+//  clamped like it is now, the old code copied one block
+//  past the end of the row.
+//
+void OldUpdateBox(int x, int y, int w, int h)
+{
+    int i, j, k, count;
+    int sp_x1, sp_x2;
+    int offset;
+    int step;
+    byte *dest, *source;
+
+    sp_x1 = x / 8;
+    sp_x2 = (x + w) / 8;
+
+    if (sp_x2 > SCREENWIDTH / 8 - 1)
+        sp_x2 = SCREENWIDTH / 8 - 1;
+
+    count = sp_x2 - sp_x1 + 1;
+    offset = y * SCREENWIDTH + sp_x1 * 8;
+    step = SCREENWIDTH - count * 8;
+
+    for (i = 0; i < 4; i++)
+    {
+        source = &screen[offset + i];
+        dest = oldpage[i] + offset / 4;
+
+        for (j = 0; j < h; j++)
+        {
+            k = count;
+
+            while (k--)
+            {
+                *(unsigned short *)dest = (unsigned short)((source[4] << 8) + source[0]);
+                dest += 2;
+                source += 8;
+            }
+
+            source += step;
+            dest += step / 4;
+        }
+    }
+}
+
+//
+// NewUpdateBox
+// I_UpdateBox as it is now.
+//
+void NewUpdateBox(int x, int y, int w, int h)
+{
+    int i;
+    int sp_x1, sp_x2;
+
+    sp_x1 = x / 8;
+    sp_x2 = (x + w) / 8;
+
+    if (sp_x2 > SCREENWIDTH / 8 - 1)
+        sp_x2 = SCREENWIDTH / 8 - 1;
+
+    for (i = 0; i < 4; i++)
+    {
+        I_CopyBoxPlane(page[i] + y * (SCREENWIDTH / 4) + sp_x1 * 2,
+                       screen + y * SCREENWIDTH + sp_x1 * 8 + i,
+                       sp_x1, sp_x2, h);
+    }
+}
+
+int main(void)
+{
+    int i;
+    int x;
+    int y;
+    int w;
+    int h;
+    int boxes;
+    int failed;
+
+    for (i = 0; i < sizeof(screen); i++)
+        screen[i] = rand();
+
+    boxes = 0;
+    failed = 0;
+
+    for (x = 0; x < SCREENWIDTH; x += 3)
+    {
+        for (w = 1; x + w <= SCREENWIDTH; w += 5)
+        {
+            for (h = 0; h <= 3; h++)
+            {
+                y = (x + w) % (SCREENHEIGHT - h);
+
+                memset(page, 0, sizeof(page));
+                memset(oldpage, 0, sizeof(oldpage));
+
+                OldUpdateBox(x, y, w, h);
+                NewUpdateBox(x, y, w, h);
+                boxes++;
+
+                if (memcmp(page, oldpage, sizeof(page)))
+                {
+                    printf("box %d,%d %dx%d differs\n", x, y, w, h);
+                    failed++;
+                }
+            }
+        }
+    }
+
+    // a full screen, the largest copy there is
+    memset(page, 0, sizeof(page));
+    memset(oldpage, 0, sizeof(oldpage));
+    OldUpdateBox(0, 0, SCREENWIDTH, SCREENHEIGHT);
+    NewUpdateBox(0, 0, SCREENWIDTH, SCREENHEIGHT);
+    boxes++;
+
+    if (memcmp(page, oldpage, sizeof(page)))
+    {
+        printf("full screen differs\n");
+        failed++;
+    }
+
+    printf("planetest: %d boxes, %s\n", boxes, failed ? "FAILED" : "ok");
+
+    return failed != 0;
+}
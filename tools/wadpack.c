@@ -0,0 +1,434 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Host tool, packs the lumps of a WAD for W_UnpackLump.
+//	Build it with any C compiler:
+//	 cc -O2 -o wadpack wadpack.c
+//	Usage:
+//	 wadpack in.wad out.wad
+//	A packed lump has LUMP_PACKED set in name[0], keeps
+//	 its unpacked size in the directory, and stores its
+//	 packed size in front of the LZSS data. Lumps that
+//	 don't get smaller, or could not be unpacked in place
+//	 by the engine, are copied as they are.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LUMP_PACKED 0x80
+
+#define WINDOW 4096
+#define MINMATCH 3
+#define MAXMATCH 18
+#define HASHSIZE 4096
+#define MAXCHAIN 256
+
+// Pack results that aren't a packed size
+#define PACK_RAW -1     // doesn't get smaller
+#define PACK_OVERLAP -2 // can't be unpacked in place
+
+typedef unsigned char byte;
+
+typedef struct
+{
+    int filepos;
+    int size;
+    char name[8];
+} filelump_t;
+
+int hashhead[HASHSIZE];
+int *hashprev;
+
+int GetLong(byte *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);
+}
+
+void PutLong(byte *p, int v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+int Hash(byte *p)
+{
+    return ((p[0] << 4) ^ (p[1] << 2) ^ p[2]) & (HASHSIZE - 1);
+}
+
+//
+// Pack
+// Returns the packed size, PACK_RAW or PACK_OVERLAP.
+//  The engine reads the packed data to the end of the
+//  output buffer and unpacks it in place, so the output
+//  may never overtake the input.
+// The first literals bytes from split are stored as
+//  literals even if they match. The start of the last
+//  match is returned in lastmatch.
+//
+int Pack(byte *src, int size, byte *dest, int split, int literals, int *lastmatch)
+{
+    int in;
+    int out;
+    int flagpos;
+    int bit;
+    int i;
+    int h;
+    int cand;
+    int chain;
+    int len;
+    int bestlen;
+    int bestdist;
+    int items;
+    int *itemin;
+    int *itemout;
+    int base;
+
+    *lastmatch = -1;
+
+    if (size < 16)
+        return PACK_RAW;
+
+    for (i = 0; i < HASHSIZE; i++)
+        hashhead[i] = -1;
+
+    hashprev = malloc(size * sizeof(int));
+    itemin = malloc((size + 1) * sizeof(int));
+    itemout = malloc((size + 1) * sizeof(int));
+
+    in = 0;
+    out = 0;
+    flagpos = 0;
+    bit = 8;
+    items = 0;
+
+    while (in < size)
+    {
+        if (bit == 8)
+        {
+            flagpos = out++;
+            dest[flagpos] = 0;
+            bit = 0;
+        }
+
+        // longest match in the window
+        bestlen = 0;
+        bestdist = 0;
+
+        if (in + MINMATCH <= size && (in < split || in >= split + literals))
+        {
+            cand = hashhead[Hash(src + in)];
+
+            for (chain = 0; cand >= 0 && in - cand <= WINDOW && chain < MAXCHAIN; chain++)
+            {
+                for (len = 0; len < MAXMATCH && in + len < size; len++)
+                {
+                    if (src[cand + len] != src[in + len])
+                        break;
+                }
+
+                if (len > bestlen)
+                {
+                    bestlen = len;
+                    bestdist = in - cand;
+                }
+
+                cand = hashprev[cand];
+            }
+        }
+
+        if (bestlen >= MINMATCH)
+        {
+            *lastmatch = in;
+            h = ((bestdist - 1) << 4) | (bestlen - MINMATCH);
+            dest[out++] = h;
+            dest[out++] = h >> 8;
+            len = bestlen;
+        }
+        else
+        {
+            dest[flagpos] |= 1 << bit;
+            dest[out++] = src[in];
+            len = 1;
+        }
+
+        bit++;
+
+        // input used and output made by this item
+        itemin[items] = out;
+        itemout[items] = in + len;
+        items++;
+
+        for (i = 0; i < len; i++, in++)
+        {
+            if (in + MINMATCH <= size)
+            {
+                h = Hash(src + in);
+                hashprev[in] = hashhead[h];
+                hashhead[h] = in;
+            }
+        }
+
+        if (out + 4 >= size)
+            break;
+    }
+
+    free(hashprev);
+
+    if (in < size)
+    {
+        free(itemin);
+        free(itemout);
+        return PACK_RAW;
+    }
+
+    // Check it can be unpacked in place: everything an
+    //  item writes has to end before the next input read.
+    base = size - out;
+
+    for (i = 0; i < items - 1; i++)
+    {
+        if (itemout[i] > base + itemin[i])
+            break;
+    }
+
+    free(itemin);
+    free(itemout);
+
+    if (i < items - 1)
+        return PACK_OVERLAP;
+
+    return out;
+}
+
+//
+// PackInPlace
+// When the literals after the last match start a new
+//  flag group, their flag byte is overwritten before it
+//  is read. Storing the start of the last match as more
+//  and more literals moves the flag groups along until
+//  the literals at the end share the last match's group.
+//
+int PackInPlace(byte *src, int size, byte *dest)
+{
+    int packedsize;
+    int lastmatch;
+    int split;
+    int literals;
+
+    packedsize = Pack(src, size, dest, -1, 0, &lastmatch);
+    split = lastmatch;
+
+    for (literals = 1; packedsize == PACK_OVERLAP && split >= 0 && literals < 8; literals++)
+        packedsize = Pack(src, size, dest, split, literals, &lastmatch);
+
+    return packedsize;
+}
+
+//
+// Unpack
+// Same as W_UnpackLump, to check the result.
+//
+void Unpack(byte *dest, int size, byte *src)
+{
+    byte *end;
+    byte *from;
+    int flags;
+    int code;
+    int count;
+
+    end = dest + size;
+    flags = 0;
+
+    while (dest < end)
+    {
+        flags >>= 1;
+
+        if (!(flags & 0x100))
+            flags = *src++ | 0xff00;
+
+        if (flags & 1)
+        {
+            *dest++ = *src++;
+        }
+        else
+        {
+            code = src[0] | (src[1] << 8);
+            src += 2;
+
+            from = dest - (code >> 4) - 1;
+            count = (code & 15) + 3;
+
+            do
+            {
+                *dest++ = *from++;
+            } while (--count);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    FILE *f;
+    byte *wad;
+    long wadsize;
+    int numlumps;
+    int infotableofs;
+    filelump_t *lumps;
+    int *origpos;
+    byte *data;
+    byte *packed;
+    byte *check;
+    int datasize;
+    int i;
+    int j;
+    int size;
+    int packedsize;
+    int numpacked;
+    byte *entry;
+    byte header[12];
+
+    if (argc != 3)
+    {
+        printf("usage: wadpack in.wad out.wad\n");
+        return 1;
+    }
+
+    f = fopen(argv[1], "rb");
+
+    if (!f)
+    {
+        printf("can't open %s\n", argv[1]);
+        return 1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    wadsize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    wad = malloc(wadsize);
+
+    if ((long)fread(wad, 1, wadsize, f) != wadsize)
+    {
+        printf("can't read %s\n", argv[1]);
+        return 1;
+    }
+
+    fclose(f);
+
+    if (wadsize < 12 || (memcmp(wad, "IWAD", 4) && memcmp(wad, "PWAD", 4)))
+    {
+        printf("%s is not a WAD file\n", argv[1]);
+        return 1;
+    }
+
+    numlumps = GetLong(wad + 4);
+    infotableofs = GetLong(wad + 8);
+    lumps = malloc(numlumps * sizeof(filelump_t));
+    origpos = malloc(numlumps * sizeof(int));
+
+    for (i = 0; i < numlumps; i++)
+    {
+        entry = wad + infotableofs + i * 16;
+        origpos[i] = lumps[i].filepos = GetLong(entry);
+        lumps[i].size = GetLong(entry + 4);
+        memcpy(lumps[i].name, entry + 8, 8);
+    }
+
+    data = malloc(wadsize * 2 + 16);
+    datasize = 0;
+    numpacked = 0;
+
+    for (i = 0; i < numlumps; i++)
+    {
+        size = lumps[i].size;
+
+        // lumps that share their data stay shared
+        for (j = 0; j < i; j++)
+        {
+            if (origpos[j] == origpos[i] && lumps[j].size == size && size)
+                break;
+        }
+
+        if (j < i)
+        {
+            lumps[i].filepos = lumps[j].filepos;
+            lumps[i].name[0] |= lumps[j].name[0] & LUMP_PACKED;
+            continue;
+        }
+
+        packed = malloc(size + MAXMATCH + 16);
+        packedsize = PackInPlace(wad + origpos[i], size, packed);
+
+        if (packedsize > 0 && packedsize + 4 < size)
+        {
+            check = malloc(size);
+            Unpack(check, size, packed);
+
+            if (memcmp(check, wad + origpos[i], size))
+                packedsize = -1;
+
+            free(check);
+        }
+        else
+            packedsize = -1;
+
+        lumps[i].filepos = 12 + datasize;
+
+        if (packedsize > 0)
+        {
+            PutLong(data + datasize, packedsize);
+            memcpy(data + datasize + 4, packed, packedsize);
+            datasize += 4 + packedsize;
+            lumps[i].name[0] |= LUMP_PACKED;
+            numpacked++;
+        }
+        else
+        {
+            memcpy(data + datasize, wad + origpos[i], size);
+            datasize += size;
+        }
+
+        free(packed);
+    }
+
+    f = fopen(argv[2], "wb");
+
+    if (!f)
+    {
+        printf("can't create %s\n", argv[2]);
+        return 1;
+    }
+
+    memcpy(header, wad, 4);
+    PutLong(header + 4, numlumps);
+    PutLong(header + 8, 12 + datasize);
+    fwrite(header, 1, 12, f);
+    fwrite(data, 1, datasize, f);
+
+    for (i = 0; i < numlumps; i++)
+    {
+        PutLong(header, lumps[i].filepos);
+        PutLong(header + 4, lumps[i].size);
+        fwrite(header, 1, 8, f);
+        fwrite(lumps[i].name, 1, 8, f);
+    }
+
+    fclose(f);
+
+    printf("%s: %d of %d lumps packed, %ld -> %d bytes\n",
+           argv[2], numpacked, numlumps, wadsize, 12 + datasize + numlumps * 16);
+
+    return 0;
+}
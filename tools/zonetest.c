@@ -0,0 +1,356 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Host stress test and benchmark of the zone (z_zone.c).
+//	Build and run it from the tools directory:
+//	 cc -O2 -I.. -o zonetest zonetest.c
+//	 ./zonetest [trace]
+//	Replays an allocation trace, one operation a line:
+//	 m <slot> <size> <tag>	Z_Malloc into slot
+//	 f <slot>		Z_Free
+//	 t <slot> <tag>		Z_ChangeTag
+//	 g <tic>		set gametic
+//	 l			level load, Z_FreeTags and Z_Compact
+//	Without a trace file a built-in one is generated, a few
+//	 levels of level data and cache churn in a small zone.
+//	Operations on slots whose block was purged are skipped.
+//	Every CHECKSTEP operations the block list, the free
+//	 bins and the contents of every block are checked.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+
+#include "../z_zone.c"
+
+#define ZONESIZE (4 * 1024 * 1024)
+#define NUMSLOTS 8192
+#define CHECKSTEP 1000
+
+byte zonememory[ZONESIZE];
+
+int gametic;
+int ticcount;
+
+void *slots[NUMSLOTS];
+int slotsize[NUMSLOTS];
+
+int numops;
+clock_t checkticks;
+
+byte *I_ZoneBase(int *size)
+{
+    *size = ZONESIZE;
+    return zonememory;
+}
+
+void I_Error(char *error, ...)
+{
+    va_list argptr;
+
+    va_start(argptr, error);
+    vprintf(error, argptr);
+    va_end(argptr);
+    printf("\n");
+    exit(1);
+}
+
+//
+// Fail
+//
+void Fail(char *what)
+{
+    printf("zonetest: %s after %d operations\n", what, numops);
+    exit(1);
+}
+
+//
+// CheckZone
+// The block list, the free bins and the block contents.
+//
+void CheckZone(void)
+{
+    memblock_t *block;
+    int total;
+    int numfree;
+    int numbinned;
+    int i;
+    int j;
+    byte *data;
+    clock_t start;
+
+    start = clock();
+    total = 0;
+    numfree = 0;
+
+    for (block = mainzone->blocklist.next; block != &mainzone->blocklist; block = block->next)
+    {
+        if (block->next->prev != block)
+            Fail("broken block links");
+
+        if (block->next != &mainzone->blocklist && (byte *)block + block->size != (byte *)block->next)
+            Fail("gap or overlap between blocks");
+
+        if (!block->user)
+        {
+            numfree++;
+
+            if (!block->next->user)
+                Fail("two free blocks in a row");
+
+            if (block->size < MINBLOCK)
+                Fail("free block too small for its links");
+        }
+        else if (block->user > (void **)&slots[NUMSLOTS - 1] || block->user < (void **)slots ||
+                 *block->user != (byte *)block + sizeof(memblock_t))
+        {
+            Fail("user does not point back at its block");
+        }
+
+        total += block->size;
+    }
+
+    if (total != mainzone->size - sizeof(memzone_t))
+        Fail("blocks don't add up to the zone size");
+
+    numbinned = 0;
+
+    for (i = 0; i < NUMBINS; i++)
+    {
+        if (!freebins[i] != !(freebinmask[i >> 5] & (1 << (i & 31))))
+            Fail("bin mask out of date");
+
+        for (block = freebins[i]; block; block = FREELINKS(block)->next)
+        {
+            if (block->user)
+                Fail("used block in a bin");
+
+            if (Z_BinForSize(block->size) != i)
+                Fail("block in the wrong bin");
+
+            if (FREELINKS(block)->next && FREELINKS(FREELINKS(block)->next)->prev != block)
+                Fail("broken bin links");
+
+            numbinned++;
+        }
+    }
+
+    if (numbinned != numfree)
+        Fail("free blocks missing from the bins");
+
+    for (i = 0; i < NUMSLOTS; i++)
+    {
+        if (!slots[i])
+            continue;
+
+        data = slots[i];
+
+        for (j = 0; j < slotsize[i]; j++)
+        {
+            if (data[j] != (byte)(i + j))
+                Fail("block contents overwritten");
+        }
+    }
+
+    checkticks += clock() - start;
+}
+
+//
+// Replay
+// Runs one trace operation.
+//
+void Replay(char op, int slot, int value, int tag)
+{
+    byte *data;
+    int i;
+
+    if (slot < 0 || slot >= NUMSLOTS)
+        Fail("slot out of range");
+
+    switch (op)
+    {
+    case 'm':
+        if (slots[slot])
+            Z_Free(slots[slot]);
+
+        data = Z_Malloc(value, tag, &slots[slot]);
+        slotsize[slot] = value;
+
+        for (i = 0; i < value; i++)
+            data[i] = i + slot;
+        break;
+
+    case 'f':
+        if (slots[slot])
+            Z_Free(slots[slot]);
+        break;
+
+    case 't':
+        if (slots[slot])
+            Z_ChangeTag(slots[slot], value);
+        break;
+
+    case 'g':
+        gametic = value;
+        break;
+
+    case 'l':
+        Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+        Z_Compact();
+        break;
+
+    default:
+        Fail("unknown operation");
+    }
+
+    numops++;
+
+    if (!(numops % CHECKSTEP))
+        CheckZone();
+}
+
+//
+// ReplayFile
+//
+void ReplayFile(char *name)
+{
+    FILE *f;
+    char line[128];
+    char op;
+    int slot;
+    int value;
+    int tag;
+
+    f = fopen(name, "r");
+
+    if (!f)
+    {
+        printf("zonetest: can't open %s\n", name);
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), f))
+    {
+        slot = value = tag = 0;
+
+        switch (line[0])
+        {
+        case 'm':
+            sscanf(line + 1, "%d %d %d", &slot, &value, &tag);
+            break;
+        case 'f':
+            sscanf(line + 1, "%d", &slot);
+            break;
+        case 't':
+            sscanf(line + 1, "%d %d", &slot, &value);
+            break;
+        case 'g':
+            sscanf(line + 1, "%d", &value);
+            break;
+        case 'l':
+            break;
+        default:
+            continue;
+        }
+
+        op = line[0];
+        Replay(op, slot, value, tag);
+    }
+
+    fclose(f);
+}
+
+//
+// ReplayBuiltin
+// Levels of up to a megabyte of level data, the
+//  same pattern of cache loads as a game, patches
+//  and sounds mostly small, now and then a big one.
+//
+void ReplayBuiltin(void)
+{
+    int level;
+    int tic;
+    int i;
+    int slot;
+    int size;
+
+    srand(1);
+
+    for (level = 0; level < 8; level++)
+    {
+        Replay('l', 0, 0, 0);
+
+        // level data, the low slots
+        for (i = 0; i < 1500; i++)
+        {
+            size = rand() % 8 ? rand() % 256 + 1 : rand() % 8192 + 1;
+            Replay('m', i, size, rand() % 4 ? PU_LEVEL : PU_LEVSPEC);
+        }
+
+        for (tic = 0; tic < 3000; tic++)
+        {
+            Replay('g', 0, level * 3000 + tic, 0);
+
+            for (i = 0; i < 8; i++)
+            {
+                slot = 2000 + rand() % (NUMSLOTS - 2000);
+
+                if (slots[slot])
+                {
+                    // a hit makes it static while used
+                    Replay('t', slot, PU_STATIC, 0);
+                    Replay('t', slot, PU_CACHE, 0);
+                }
+                else
+                {
+                    size = rand() % 16 ? rand() % 4096 + 1 : rand() % 65536 + 1;
+                    Replay('m', slot, size, PU_CACHE);
+                }
+            }
+
+            // thinkers come and go
+            slot = 1500 + rand() % 500;
+
+            if (slots[slot])
+                Replay('f', slot, 0, 0);
+            else
+                Replay('m', slot, rand() % 200 + 16, PU_LEVEL);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    clock_t start;
+    clock_t ticks;
+
+    Z_Init();
+
+    start = clock();
+
+    if (argc > 1)
+        ReplayFile(argv[1]);
+    else
+        ReplayBuiltin();
+
+    ticks = clock() - start - checkticks;
+
+    CheckZone();
+
+    printf("zonetest: %d operations in %d ms, not counting the checks, ok\n",
+           numops, (int)(ticks * 1000 / CLOCKS_PER_SEC));
+
+    return 0;
+}
@@ -32,7 +32,9 @@
 // Each screen is [SCREENWIDTH*SCREENHEIGHT];
 byte *screens[5];
 
-int dirtybox[4];
+// What changed in screens[0] this frame, see V_MarkRect.
+dirtyrect_t dirtyrects[MAXDIRTYRECTS];
+int numdirtyrects;
 
 // Now where did these came from?
 byte gammatable[5][256] =
@@ -138,6 +140,90 @@ byte gammatable[5][256] =
 
 int usegamma;
 
+//
+// V_AddDirtyRect
+// Adds add to a list of at most MAXDIRTYRECTS rectangles.
+// Rectangles that overlap or come within DIRTYMERGE
+//  pixels of it are merged into it first, so a message
+//  in one corner and the status bar in the other stay
+//  two small copies.
+//
+void V_AddDirtyRect(dirtyrect_t *rects,
+                    int *count,
+                    dirtyrect_t *add)
+{
+    dirtyrect_t rect;
+    dirtyrect_t *r;
+    boolean merged;
+    int i;
+    int best;
+    int area;
+    int bestarea;
+
+    rect = *add;
+
+    do
+    {
+        merged = false;
+
+        for (i = 0, r = rects; i < *count; i++, r++)
+        {
+            if (rect.x1 > r->x2 + DIRTYMERGE || rect.x2 < r->x1 - DIRTYMERGE ||
+                rect.y1 > r->y2 + DIRTYMERGE || rect.y2 < r->y1 - DIRTYMERGE)
+                continue;
+
+            // Take it out of the list and try again
+            //  with the union.
+            if (r->x1 < rect.x1)
+                rect.x1 = r->x1;
+            if (r->y1 < rect.y1)
+                rect.y1 = r->y1;
+            if (r->x2 > rect.x2)
+                rect.x2 = r->x2;
+            if (r->y2 > rect.y2)
+                rect.y2 = r->y2;
+
+            *r = rects[--*count];
+            merged = true;
+            break;
+        }
+    } while (merged);
+
+    if (*count < MAXDIRTYRECTS)
+    {
+        rects[(*count)++] = rect;
+        return;
+    }
+
+    // No room, grow the rectangle that grows least.
+    best = 0;
+    bestarea = MAXINT;
+
+    for (i = 0, r = rects; i < *count; i++, r++)
+    {
+        area = ((rect.x2 > r->x2 ? rect.x2 : r->x2) - (rect.x1 < r->x1 ? rect.x1 : r->x1) + 1) *
+                   ((rect.y2 > r->y2 ? rect.y2 : r->y2) - (rect.y1 < r->y1 ? rect.y1 : r->y1) + 1) -
+               (r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+
+        if (area < bestarea)
+        {
+            bestarea = area;
+            best = i;
+        }
+    }
+
+    r = &rects[best];
+
+    if (rect.x1 < r->x1)
+        r->x1 = rect.x1;
+    if (rect.y1 < r->y1)
+        r->y1 = rect.y1;
+    if (rect.x2 > r->x2)
+        r->x2 = rect.x2;
+    if (rect.y2 > r->y2)
+        r->y2 = rect.y2;
+}
+
 //
 // V_MarkRect
 //
@@ -146,8 +232,22 @@ void V_MarkRect(int x,
                 int width,
                 int height)
 {
-    M_AddToBox(dirtybox, x, y);
-    M_AddToBox(dirtybox, x + width - 1, y + height - 1);
+    dirtyrect_t rect;
+
+    rect.x1 = x < 0 ? 0 : x;
+    rect.y1 = y < 0 ? 0 : y;
+    rect.x2 = x + width - 1;
+    rect.y2 = y + height - 1;
+
+    if (rect.x2 > SCREENWIDTH - 1)
+        rect.x2 = SCREENWIDTH - 1;
+    if (rect.y2 > SCREENHEIGHT - 1)
+        rect.y2 = SCREENHEIGHT - 1;
+
+    if (rect.x1 > rect.x2 || rect.y1 > rect.y2)
+        return;
+
+    V_AddDirtyRect(dirtyrects, &numdirtyrects, &rect);
 }
 
 //
@@ -296,6 +396,191 @@ void V_DrawPatchFlipped(int x,
     }
 }
 
+//
+// LISTED PATCHES
+// Screens that change little from frame to frame (the
+//  intermission, the finale) keep their static background
+//  in screens[1] and list the patches drawn on top of it
+//  every frame. V_FlushPatches only restores and redraws
+//  the areas where the list differs from the last one.
+// Listed patches have to stay in memory until then.
+//
+#define MAXLISTPATCHES 128
+
+typedef struct
+{
+    int x;
+    int y;
+    patch_t *patch;
+    boolean flipped;
+    dirtyrect_t rect;
+} listpatch_t;
+
+listpatch_t listpatches[2][MAXLISTPATCHES];
+int numlistpatches[2];
+int curpatchlist;
+
+boolean patchrefresh = true;
+boolean patchoverlay;
+
+//
+// V_RefreshPatches
+// The background changed, redraw everything
+//  on the next flush.
+//
+void V_RefreshPatches(void)
+{
+    patchrefresh = true;
+}
+
+//
+// V_ListPatch
+//
+void V_ListPatch(int x,
+                 int y,
+                 patch_t *patch,
+                 boolean flipped)
+{
+    listpatch_t *lp;
+
+    if (numlistpatches[curpatchlist] == MAXLISTPATCHES)
+    {
+        patchrefresh = true;
+        return;
+    }
+
+    lp = &listpatches[curpatchlist][numlistpatches[curpatchlist]++];
+    lp->x = x;
+    lp->y = y;
+    lp->patch = patch;
+    lp->flipped = flipped;
+
+    lp->rect.x1 = x - SHORT(patch->leftoffset);
+    lp->rect.y1 = y - SHORT(patch->topoffset);
+    lp->rect.x2 = lp->rect.x1 + SHORT(patch->width) - 1;
+    lp->rect.y2 = lp->rect.y1 + SHORT(patch->height) - 1;
+}
+
+//
+// V_RectTouches
+//
+boolean V_RectTouches(dirtyrect_t *rect,
+                      dirtyrect_t *rects,
+                      int count)
+{
+    for (; count--; rects++)
+    {
+        if (rect->x1 <= rects->x2 && rect->x2 >= rects->x1 &&
+            rect->y1 <= rects->y2 && rect->y2 >= rects->y1)
+            return true;
+    }
+
+    return false;
+}
+
+//
+// V_FlushPatches
+// Brings screens[0] up to date with the patches listed
+//  since the last flush. overlay is set while something
+//  (the menu, the pause sign) is drawn straight to the
+//  screen, everything is redrawn until it is gone.
+//
+void V_FlushPatches(boolean overlay)
+{
+    listpatch_t *cur;
+    listpatch_t *old;
+    int numcur;
+    int numold;
+    dirtyrect_t rects[MAXDIRTYRECTS];
+    int numrects;
+    boolean redraw[MAXLISTPATCHES];
+    boolean added;
+    dirtyrect_t *r;
+    int i;
+
+    cur = listpatches[curpatchlist];
+    numcur = numlistpatches[curpatchlist];
+    old = listpatches[curpatchlist ^ 1];
+    numold = numlistpatches[curpatchlist ^ 1];
+
+    if (patchrefresh || overlay || patchoverlay)
+    {
+        memcpy(screens[0], screens[1], SCREENWIDTH * SCREENHEIGHT);
+        V_MarkRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
+
+        for (i = 0; i < numcur; i++)
+            redraw[i] = true;
+    }
+    else
+    {
+        // What changed since the last frame.
+        numrects = 0;
+
+        for (i = 0; i < numcur || i < numold; i++)
+        {
+            if (i < numcur && i < numold && cur[i].patch == old[i].patch &&
+                cur[i].x == old[i].x && cur[i].y == old[i].y && cur[i].flipped == old[i].flipped)
+                continue;
+
+            if (i < numcur)
+                V_AddDirtyRect(rects, &numrects, &cur[i].rect);
+            if (i < numold)
+                V_AddDirtyRect(rects, &numrects, &old[i].rect);
+        }
+
+        // Patches that overlap those areas are redrawn whole,
+        //  so the areas grow until no other patch touches them.
+        memset(redraw, 0, sizeof(redraw));
+
+        do
+        {
+            added = false;
+
+            for (i = 0; i < numcur; i++)
+            {
+                if (!redraw[i] && V_RectTouches(&cur[i].rect, rects, numrects))
+                {
+                    redraw[i] = true;
+                    V_AddDirtyRect(rects, &numrects, &cur[i].rect);
+                    added = true;
+                }
+            }
+        } while (added);
+
+        for (i = 0, r = rects; i < numrects; i++, r++)
+        {
+            if (r->x1 < 0)
+                r->x1 = 0;
+            if (r->y1 < 0)
+                r->y1 = 0;
+            if (r->x2 > SCREENWIDTH - 1)
+                r->x2 = SCREENWIDTH - 1;
+            if (r->y2 > SCREENHEIGHT - 1)
+                r->y2 = SCREENHEIGHT - 1;
+
+            if (r->x1 <= r->x2 && r->y1 <= r->y2)
+                V_CopyRect(r->x1, r->y1, 1, r->x2 - r->x1 + 1, r->y2 - r->y1 + 1, r->x1, r->y1, 0);
+        }
+    }
+
+    for (i = 0; i < numcur; i++)
+    {
+        if (!redraw[i])
+            continue;
+
+        if (cur[i].flipped)
+            V_DrawPatchFlipped(cur[i].x, cur[i].y, 0, cur[i].patch);
+        else
+            V_DrawPatch(cur[i].x, cur[i].y, 0, cur[i].patch);
+    }
+
+    patchrefresh = false;
+    patchoverlay = overlay;
+
+    curpatchlist ^= 1;
+    numlistpatches[curpatchlist] = 0;
+}
+
 //
 // V_DrawPatchDirect
 // Draws directly to the screen on the pc.
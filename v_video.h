@@ -39,7 +39,24 @@
 
 extern byte *screens[5];
 
-extern int dirtybox[4];
+//
+// Dirty rectangles, inclusive.
+//
+#define MAXDIRTYRECTS 16
+
+// Rectangles closer than this are merged.
+#define DIRTYMERGE 16
+
+typedef struct
+{
+    int x1;
+    int y1;
+    int x2;
+    int y2;
+} dirtyrect_t;
+
+extern dirtyrect_t dirtyrects[MAXDIRTYRECTS];
+extern int numdirtyrects;
 
 extern byte gammatable[5][256];
 extern int usegamma;
@@ -66,6 +83,22 @@ void V_DrawPatchDirect(int x,
                        int scrn,
                        patch_t *patch);
 
+// Patches over the background in screens[1],
+//  redrawn only where they change.
+void V_RefreshPatches(void);
+
+void V_ListPatch(int x,
+                 int y,
+                 patch_t *patch,
+                 boolean flipped);
+
+void V_FlushPatches(boolean overlay);
+
+void V_DrawPatchFlipped(int x,
+                        int y,
+                        int scrn,
+                        patch_t *patch);
+
 // Draw a linear block of pixels into the view buffer.
 void V_DrawBlock(int x,
                  int y,
@@ -79,4 +112,8 @@ void V_MarkRect(int x,
                 int width,
                 int height);
 
+void V_AddDirtyRect(dirtyrect_t *rects,
+                    int *count,
+                    dirtyrect_t *add);
+
 #endif
@@ -18,6 +18,7 @@
 
 #include <ctype.h>
 #include <sys/types.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <malloc.h>
@@ -29,6 +30,7 @@
 #include "doomstat.h"
 #include "i_system.h"
 #include "z_zone.h"
+#include "d_main.h"
 
 #include "w_wad.h"
 
@@ -105,6 +107,7 @@ void W_AddFile(char *filename)
     filelump_t *fileinfo;
     filelump_t singleinfo;
     int storehandle;
+    byte *image;
 
     // open the file and add to directory
 
@@ -169,12 +172,33 @@ void W_AddFile(char *filename)
 
     storehandle = reloadname ? -1 : handle;
 
+    image = NULL;
+
+    if (wadImage && !reloadname)
+    {
+        // keep the whole file resident
+        length = filelength(handle);
+        image = malloc(length);
+
+        if (!image)
+            I_Error("W_AddFile: no memory to load %s", filename);
+
+        lseek(handle, 0, SEEK_SET);
+
+        if (read(handle, image, length) != length)
+            I_Error("W_AddFile: couldn't read %s", filename);
+    }
+
     for (i = startlump; i < numlumps; i++, lump_p++, fileinfo++)
     {
         lump_p->handle = storehandle;
         lump_p->position = LONG(fileinfo->filepos);
         lump_p->size = LONG(fileinfo->size);
+        lump_p->image = image ? image + lump_p->position : NULL;
         strncpy(lump_p->name, fileinfo->name, 8);
+
+        lump_p->packed = (lump_p->name[0] & LUMP_PACKED) != 0;
+        lump_p->name[0] &= ~LUMP_PACKED;
     }
 
     if (reloadname)
@@ -222,6 +246,7 @@ void W_Reload(void)
 
         lump_p->position = LONG(fileinfo->filepos);
         lump_p->size = LONG(fileinfo->size);
+        lump_p->packed = (fileinfo->name[0] & LUMP_PACKED) != 0;
     }
 
     close(handle);
@@ -253,6 +278,8 @@ void W_InitMultipleFiles(char **filenames)
     for (; *filenames; filenames++)
         W_AddFile(*filenames);
 
+    D_Timing("W_AddFile");
+
     if (!numlumps)
         I_Error("W_InitFiles: no files found");
 
@@ -266,6 +293,7 @@ void W_InitMultipleFiles(char **filenames)
     memset(lumpcache, 0, size);
 
     W_GenerateHashTable();
+    D_Timing("W_GenerateHashTable");
 }
 
 // Hash function used for lump names.
@@ -308,6 +336,55 @@ int W_GetNumForName(char *name)
     return -1;
 }
 
+//
+// W_UnpackLump
+// Packed lumps hold their packed size, then LZSS data:
+//  a flag byte for each eight items, LSB first, set for
+//  a literal byte, clear for a 16 bit copy of 3-18 bytes
+//  from 1-4096 bytes back.
+// wadpack only packs a lump if it can be read to the end
+//  of the buffer and unpacked in place.
+//
+void W_UnpackLump(byte *dest,
+                  int size,
+                  byte *src)
+{
+    byte *end;
+    byte *from;
+    int flags;
+    int code;
+    int count;
+
+    end = dest + size;
+    flags = 0;
+
+    while (dest < end)
+    {
+        flags >>= 1;
+
+        if (!(flags & 0x100))
+            flags = *src++ | 0xff00;
+
+        if (flags & 1)
+        {
+            *dest++ = *src++;
+        }
+        else
+        {
+            code = src[0] | (src[1] << 8);
+            src += 2;
+
+            from = dest - (code >> 4) - 1;
+            count = (code & 15) + 3;
+
+            do
+            {
+                *dest++ = *from++;
+            } while (--count);
+        }
+    }
+}
+
 //
 // W_ReadLump
 // Loads the lump into the given buffer,
@@ -322,6 +399,15 @@ void W_ReadLump(int lump,
 
     l = lumpinfo + lump;
 
+    if (l->image)
+    {
+        if (l->packed)
+            W_UnpackLump(dest, l->size, (byte *)l->image + 4);
+        else
+            memcpy(dest, l->image, l->size);
+        return;
+    }
+
     if (l->handle == -1)
     {
         // reloadable file, so use open / read / close
@@ -331,7 +417,24 @@ void W_ReadLump(int lump,
         handle = l->handle;
 
     lseek(handle, l->position, SEEK_SET);
-    c = read(handle, dest, l->size);
+
+    if (l->packed)
+    {
+        if (read(handle, &c, 4) != 4)
+            I_Error("W_ReadLump: couldn't read lump %i", lump);
+
+        c = LONG(c);
+
+        if (c <= 0 || c > l->size)
+            I_Error("W_ReadLump: bad packed size %i on lump %i", c, lump);
+
+        if (read(handle, (byte *)dest + l->size - c, c) != c)
+            I_Error("W_ReadLump: couldn't read lump %i", lump);
+
+        W_UnpackLump(dest, l->size, (byte *)dest + l->size - c);
+    }
+    else
+        c = read(handle, dest, l->size);
 
     if (l->handle == -1)
         close(handle);
@@ -348,6 +451,10 @@ W_CacheLumpNum(int lump,
 
     if (!lumpcache[lump])
     {
+        // resident lumps are used in place
+        if (lumpinfo[lump].image && !lumpinfo[lump].packed)
+            return lumpinfo[lump].image;
+
         // read the lump in
 
         ptr = Z_Malloc(W_LumpLength(lump), tag, &lumpcache[lump]);
@@ -361,6 +468,223 @@ W_CacheLumpNum(int lump,
     return lumpcache[lump];
 }
 
+//
+// W_CacheLumpNumWritable
+// For callers that change the lump, always
+//  returns a copy in the zone.
+//
+void *
+W_CacheLumpNumWritable(int lump,
+                       int tag)
+{
+    if (!lumpcache[lump])
+    {
+        Z_Malloc(W_LumpLength(lump), tag, &lumpcache[lump]);
+        W_ReadLump(lump, lumpcache[lump]);
+    }
+    else
+    {
+        Z_ChangeTag(lumpcache[lump], tag);
+    }
+
+    return lumpcache[lump];
+}
+
+//
+// W_CacheLumpList
+// Caches a set of lumps, reading them in file order.
+// Lumps that lie close together are read in one go,
+//  the gaps between them cost less than the seeks.
+// The list is sorted in place.
+//
+#define MAXLISTREAD 0x10000
+#define MAXLISTGAP 0x2000
+
+int W_CompareLumps(const void *a, const void *b)
+{
+    lumpinfo_t *la;
+    lumpinfo_t *lb;
+
+    la = &lumpinfo[*(int *)a];
+    lb = &lumpinfo[*(int *)b];
+
+    if (la->handle != lb->handle)
+        return la->handle - lb->handle;
+
+    return la->position - lb->position;
+}
+
+void W_CacheLumpList(int *lumps,
+                     int count,
+                     int tag)
+{
+    int i;
+    int j;
+    int k;
+    int num;
+    int start;
+    int end;
+    int handle;
+    byte *buffer;
+    lumpinfo_t *l;
+
+    // leave out what doesn't need reading
+    num = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        l = &lumpinfo[lumps[i]];
+
+        if (lumpcache[lumps[i]] || l->image || l->packed || l->handle == -1 || l->size > MAXLISTREAD)
+            W_CacheLumpNum(lumps[i], tag);
+        else
+            lumps[num++] = lumps[i];
+    }
+
+    if (!num)
+        return;
+
+    qsort(lumps, num, sizeof(*lumps), W_CompareLumps);
+
+    buffer = Z_Malloc(MAXLISTREAD, PU_STATIC, NULL);
+
+    for (i = 0; i < num; i = j)
+    {
+        l = &lumpinfo[lumps[i]];
+        handle = l->handle;
+        start = l->position;
+        end = start + l->size;
+
+        // take in the lumps that follow closely
+        for (j = i + 1; j < num; j++)
+        {
+            l = &lumpinfo[lumps[j]];
+
+            if (l->handle != handle || l->position > end + MAXLISTGAP ||
+                l->position + l->size - start > MAXLISTREAD)
+                break;
+
+            if (l->position + l->size > end)
+                end = l->position + l->size;
+        }
+
+        lseek(handle, start, SEEK_SET);
+
+        if (read(handle, buffer, end - start) != end - start)
+            I_Error("W_CacheLumpList: couldn't read lumps %i to %i",
+                    lumps[i], lumps[j - 1]);
+
+        for (k = i; k < j; k++)
+        {
+            // listed twice
+            if (lumpcache[lumps[k]])
+                continue;
+
+            l = &lumpinfo[lumps[k]];
+            Z_Malloc(l->size, tag, &lumpcache[lumps[k]]);
+            memcpy(lumpcache[lumps[k]], buffer + l->position - start, l->size);
+        }
+    }
+
+    Z_Free(buffer);
+}
+
+//
+// PREFETCHING
+// Lumps that will probably be needed soon are queued,
+//  and read a chunk at a time while TryRunTics waits
+//  for the next tic. When the queue is full they are
+//  dropped, they will be read when needed.
+//
+#define PREFETCHSIZE 256
+#define PREFETCHCHUNK 0x1000
+
+int prefetchqueue[PREFETCHSIZE];
+int prefetchhead;
+int prefetchtail;
+
+int prefetchlump = -1; // being read
+int prefetchpos;
+byte *prefetchdata;
+
+//
+// W_Prefetch
+//
+void W_Prefetch(int lump)
+{
+    int head;
+
+    if (lump < 0 || lumpcache[lump] || lumpinfo[lump].image || lumpinfo[lump].packed || lumpinfo[lump].handle == -1)
+        return;
+
+    head = (prefetchhead + 1) & (PREFETCHSIZE - 1);
+
+    if (head == prefetchtail)
+        return;
+
+    prefetchqueue[prefetchhead] = lump;
+    prefetchhead = head;
+}
+
+//
+// W_ServicePrefetch
+// Reads at most PREFETCHCHUNK bytes.
+//
+void W_ServicePrefetch(void)
+{
+    lumpinfo_t *l;
+    int length;
+
+    // find a lump that still isn't cached
+    while (prefetchlump == -1)
+    {
+        if (prefetchtail == prefetchhead)
+            return;
+
+        prefetchlump = prefetchqueue[prefetchtail];
+        prefetchtail = (prefetchtail + 1) & (PREFETCHSIZE - 1);
+
+        if (lumpcache[prefetchlump])
+            prefetchlump = -1;
+    }
+
+    l = &lumpinfo[prefetchlump];
+
+    // cached in the meantime, or purged before it was done
+    if (lumpcache[prefetchlump] || (prefetchpos && !prefetchdata))
+    {
+        if (prefetchdata)
+            Z_Free(prefetchdata);
+
+        prefetchlump = -1;
+        prefetchpos = 0;
+        return;
+    }
+
+    if (!prefetchpos)
+        Z_Malloc(l->size, PU_CACHE, &prefetchdata);
+
+    length = l->size - prefetchpos;
+
+    if (length > PREFETCHCHUNK)
+        length = PREFETCHCHUNK;
+
+    lseek(l->handle, l->position + prefetchpos, SEEK_SET);
+
+    if (read(l->handle, prefetchdata + prefetchpos, length) != length)
+        I_Error("W_ServicePrefetch: couldn't read lump %i", prefetchlump);
+    prefetchpos += length;
+
+    if (prefetchpos == l->size)
+    {
+        // hand it over to the cache
+        Z_ChangeUser(prefetchdata, &lumpcache[prefetchlump]);
+        prefetchdata = NULL;
+        prefetchlump = -1;
+        prefetchpos = 0;
+    }
+}
+
 //
 // W_CacheLumpName
 //
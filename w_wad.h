@@ -19,6 +19,8 @@
 #ifndef __W_WAD__
 #define __W_WAD__
 
+#include "doomtype.h"
+
 //
 // TYPES
 //
@@ -39,6 +41,9 @@ typedef struct
 
 } filelump_t;
 
+// Set in name[0] for packed lumps, see tools/wadpack.c.
+#define LUMP_PACKED 0x80
+
 //
 // WADFILE I/O related stuff.
 //
@@ -50,6 +55,10 @@ typedef struct
     int size;
     // Used for hash table lookups
     int next;
+    // Lump data in the resident image, or NULL
+    void *image;
+    // Stored with W_UnpackLump's LZSS, size is unpacked
+    boolean packed;
 } lumpinfo_t;
 
 extern void **lumpcache;
@@ -67,6 +76,11 @@ void W_ReadLump(int lump, void *dest);
 
 void *W_CacheLumpNum(int lump, int tag);
 void *W_CacheLumpName(char *name, int tag);
+void *W_CacheLumpNumWritable(int lump, int tag);
+void W_CacheLumpList(int *lumps, int count, int tag);
+
+void W_Prefetch(int lump);
+void W_ServicePrefetch(void);
 
 void W_GenerateHashTable(void);
 
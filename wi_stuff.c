@@ -243,7 +243,6 @@ static anim_t *anims[NUMEPISODES] =
 //
 // Locally used stuff.
 //
-#define FB 0
 
 // States for single-player
 #define SP_KILLS 0
@@ -337,26 +336,20 @@ static patch_t **lnames;
 // CODE
 //
 
-void WI_slamBackground(void)
-{
-	memcpy(screens[0], screens[1], SCREENWIDTH * SCREENHEIGHT);
-	V_MarkRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
-}
-
 // Draws "<Levelname> Finished!"
 void WI_drawLF(void)
 {
 	int y = WI_TITLEY;
 
 	// draw <LevelName>
-	V_DrawPatch((SCREENWIDTH - SHORT(lnames[wbs->last]->width)) / 2,
-				y, FB, lnames[wbs->last]);
+	V_ListPatch((SCREENWIDTH - SHORT(lnames[wbs->last]->width)) / 2,
+				y, lnames[wbs->last], false);
 
 	// draw "Finished!"
 	y += (5 * SHORT(lnames[wbs->last]->height)) / 4;
 
-	V_DrawPatch((SCREENWIDTH - SHORT(finished->width)) / 2,
-				y, FB, finished);
+	V_ListPatch((SCREENWIDTH - SHORT(finished->width)) / 2,
+				y, finished, false);
 }
 
 // Draws "Entering <LevelName>"
@@ -365,14 +358,14 @@ void WI_drawEL(void)
 	int y = WI_TITLEY;
 
 	// draw "Entering"
-	V_DrawPatch((SCREENWIDTH - SHORT(entering->width)) / 2,
-				y, FB, entering);
+	V_ListPatch((SCREENWIDTH - SHORT(entering->width)) / 2,
+				y, entering, false);
 
 	// draw level
 	y += (5 * SHORT(lnames[wbs->next]->height)) / 4;
 
-	V_DrawPatch((SCREENWIDTH - SHORT(lnames[wbs->next]->width)) / 2,
-				y, FB, lnames[wbs->next]);
+	V_ListPatch((SCREENWIDTH - SHORT(lnames[wbs->next]->width)) / 2,
+				y, lnames[wbs->next], false);
 }
 
 void WI_drawOnLnode(int n,
@@ -406,8 +399,7 @@ void WI_drawOnLnode(int n,
 
 	if (fits && i < 2)
 	{
-		V_DrawPatch(lnodes[wbs->epsd][n].x, lnodes[wbs->epsd][n].y,
-					FB, c[i]);
+		V_ListPatch(lnodes[wbs->epsd][n].x, lnodes[wbs->epsd][n].y, c[i], false);
 	}
 }
 
@@ -512,7 +504,7 @@ void WI_drawAnimatedBack(void)
 		a = &anims[wbs->epsd][i];
 
 		if (a->ctr >= 0)
-			V_DrawPatch(a->loc.x, a->loc.y, FB, a->p[a->ctr]);
+			V_ListPatch(a->loc.x, a->loc.y, a->p[a->ctr], false);
 	}
 }
 
@@ -561,7 +553,7 @@ int WI_drawNum(int x,
 	while (digits--)
 	{
 		x -= fontwidth;
-		V_DrawPatch(x, y, FB, num[n % 10]);
+		V_ListPatch(x, y, num[n % 10], false);
 		n /= 10;
 	}
 
@@ -575,7 +567,7 @@ void WI_drawPercent(int x,
 	if (p < 0)
 		return;
 
-	V_DrawPatch(x, y, FB, percent);
+	V_ListPatch(x, y, percent, false);
 	WI_drawNum(x, y, p, -1);
 }
 
@@ -606,14 +598,14 @@ void WI_drawTime(int x,
 
 			// draw
 			if (div == 60 || t / div)
-				V_DrawPatch(x, y, FB, colon);
+				V_ListPatch(x, y, colon, false);
 
 		} while (t / div);
 	}
 	else
 	{
 		// "sucks"
-		V_DrawPatch(x - SHORT(sucks->width), y, FB, sucks);
+		V_ListPatch(x - SHORT(sucks->width), y, sucks, false);
 	}
 }
 
@@ -669,8 +661,6 @@ void WI_drawShowNextLoc(void)
 	int i;
 	int last;
 
-	WI_slamBackground();
-
 	// draw animated background
 	WI_drawAnimatedBack();
 
@@ -838,30 +828,28 @@ void WI_drawStats(void)
 
 	lh = (3 * SHORT(num[0]->height)) / 2;
 
-	WI_slamBackground();
-
 	// draw animated background
 	WI_drawAnimatedBack();
 
 	WI_drawLF();
 
-	V_DrawPatch(SP_STATSX, SP_STATSY, FB, kills);
+	V_ListPatch(SP_STATSX, SP_STATSY, kills, false);
 	WI_drawPercent(SCREENWIDTH - SP_STATSX, SP_STATSY, cnt_kills);
 
-	V_DrawPatch(SP_STATSX, SP_STATSY + lh, FB, items);
+	V_ListPatch(SP_STATSX, SP_STATSY + lh, items, false);
 	WI_drawPercent(SCREENWIDTH - SP_STATSX, SP_STATSY + lh, cnt_items);
 
-	V_DrawPatch(SP_STATSX, SP_STATSY + 2 * lh, FB, sp_secret);
+	V_ListPatch(SP_STATSX, SP_STATSY + 2 * lh, sp_secret, false);
 	WI_drawPercent(SCREENWIDTH - SP_STATSX, SP_STATSY + 2 * lh, cnt_secret);
 
-	V_DrawPatch(SP_TIMEX, SP_TIMEY, FB, time);
+	V_ListPatch(SP_TIMEX, SP_TIMEY, time, false);
 	WI_drawTime(SCREENWIDTH / 2 - SP_TIMEX, SP_TIMEY, cnt_time);
 
 #if (EXE_VERSION >= EXE_VERSION_ULTIMATE)
 	if (wbs->epsd < 3)
 #endif
 	{
-		V_DrawPatch(SCREENWIDTH / 2 + SP_TIMEX, SP_TIMEY, FB, par);
+		V_ListPatch(SCREENWIDTH / 2 + SP_TIMEX, SP_TIMEY, par, false);
 		WI_drawTime(SCREENWIDTH - SP_TIMEX, SP_TIMEY, cnt_par);
 	}
 }
@@ -944,6 +932,7 @@ void WI_loadData(void)
 	// background
 	bg = W_CacheLumpName(name, PU_CACHE);
 	V_DrawPatch(0, 0, 1, bg);
+	V_RefreshPatches();
 
 	if (commercial)
 	{
@@ -1118,6 +1107,10 @@ void WI_Drawer(void)
 		WI_drawNoState();
 		break;
 	}
+
+	// Everything above only listed its patches over
+	//  the background, now draw what changed.
+	V_FlushPatches(menuactive || paused);
 }
 
 void WI_initVariables(wbstartstruct_t *wbstartstruct)
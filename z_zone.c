@@ -16,9 +16,13 @@
 //	Zone Memory Allocation. Neat.
 //
 
+#include <string.h>
+
 #include "z_zone.h"
 #include "i_system.h"
+#include "i_ibm.h"
 #include "doomdef.h"
+#include "doomstat.h"
 
 //
 // ZONE MEMORY ALLOCATION
@@ -30,6 +34,13 @@
 // It is of no value to free a cachable block,
 //  because it will get overwritten automatically if needed.
 //
+// Every free block is also linked into a bin by its size,
+//  so most allocations never have to walk the block list.
+// When no free block is big enough, the run of cachable
+//  blocks that has gone unused the longest is purged.
+// The rover is only used when every such run was used
+//  within the last zonereserve tics.
+//
 
 typedef struct
 {
@@ -45,6 +56,158 @@ typedef struct
 
 memzone_t *mainzone;
 
+int zonereserve = TICRATE;
+
+// No purgable block was used before this tic.
+// Stamps only grow, so it stays a lower bound
+//  until Z_PurgeLRU finds the real one again.
+int zoneoldest;
+
+// Lumps in the resident WAD image look like cached
+//  lumps, but are not in the zone.
+#define Z_InZone(ptr) ((byte *)(ptr) > (byte *)mainzone && \
+                       (byte *)(ptr) < (byte *)mainzone + mainzone->size)
+
+// totals for all Z_Compact calls
+int zonemoved;
+int zonecompacttics;
+
+//
+// FREE BINS
+// The links are kept in the free block's own data.
+// Small blocks get a bin per 8 bytes, larger ones
+//  a bin per power of two.
+//
+typedef struct
+{
+    memblock_t *next;
+    memblock_t *prev;
+} freelinks_t;
+
+#define FREELINKS(block) ((freelinks_t *)((byte *)(block) + sizeof(memblock_t)))
+
+#define MINBLOCK (sizeof(memblock_t) + sizeof(freelinks_t))
+#define SMALLBINS 128
+#define SMALLLIMIT (MINBLOCK + SMALLBINS * 8)
+#define SMALLLOG 10 // log2 of SMALLLIMIT, rounded down
+#define NUMBINS (SMALLBINS + 32 - SMALLLOG)
+
+memblock_t *freebins[NUMBINS];
+unsigned int freebinmask[(NUMBINS + 31) / 32];
+
+//
+// Z_BinForSize
+//
+int Z_BinForSize(int size)
+{
+    int bin;
+
+    if (size < SMALLLIMIT)
+        return (size - MINBLOCK) >> 3;
+
+    bin = SMALLBINS - SMALLLOG;
+
+    while (size >>= 1)
+        bin++;
+
+    return bin;
+}
+
+//
+// Z_Bin
+//
+void Z_Bin(memblock_t *block)
+{
+    int bin;
+    freelinks_t *links;
+
+    bin = Z_BinForSize(block->size);
+    links = FREELINKS(block);
+
+    links->prev = NULL;
+    links->next = freebins[bin];
+
+    if (freebins[bin])
+        FREELINKS(freebins[bin])->prev = block;
+
+    freebins[bin] = block;
+    freebinmask[bin >> 5] |= 1 << (bin & 31);
+}
+
+//
+// Z_Unbin
+//
+void Z_Unbin(memblock_t *block)
+{
+    int bin;
+    freelinks_t *links;
+
+    links = FREELINKS(block);
+
+    if (links->next)
+        FREELINKS(links->next)->prev = links->prev;
+
+    if (links->prev)
+    {
+        FREELINKS(links->prev)->next = links->next;
+        return;
+    }
+
+    bin = Z_BinForSize(block->size);
+    freebins[bin] = links->next;
+
+    if (!links->next)
+        freebinmask[bin >> 5] &= ~(1 << (bin & 31));
+}
+
+//
+// Z_FindFree
+// Returns a free block of at least size bytes, or NULL.
+//
+memblock_t *Z_FindFree(int size)
+{
+    int bin;
+    int word;
+    unsigned int mask;
+    memblock_t *block;
+
+    bin = Z_BinForSize(size);
+
+    // blocks in the same bin can still be too small
+    for (block = freebins[bin]; block; block = FREELINKS(block)->next)
+    {
+        if (block->size >= size)
+            return block;
+    }
+
+    // anything in a bigger bin will do
+    bin++;
+    word = bin >> 5;
+
+    if (word >= (NUMBINS + 31) / 32)
+        return NULL;
+
+    mask = freebinmask[word] & ~((1 << (bin & 31)) - 1);
+
+    while (!mask)
+    {
+        if (++word == (NUMBINS + 31) / 32)
+            return NULL;
+
+        mask = freebinmask[word];
+    }
+
+    bin = word << 5;
+
+    while (!(mask & 1))
+    {
+        mask >>= 1;
+        bin++;
+    }
+
+    return freebins[bin];
+}
+
 //
 // Z_Init
 //
@@ -71,6 +234,10 @@ void Z_Init(void)
     block->user = NULL;
 
     block->size = mainzone->size - sizeof(memzone_t);
+
+    zoneoldest = gametic;
+
+    Z_Bin(block);
 }
 
 //
@@ -81,6 +248,9 @@ void Z_Free(void *ptr)
     memblock_t *block;
     memblock_t *other;
 
+    if (!Z_InZone(ptr))
+        return;
+
     block = (memblock_t *)((byte *)ptr - sizeof(memblock_t));
 
     if (block->user > (void **)0x100)
@@ -101,6 +271,7 @@ void Z_Free(void *ptr)
     if (!other->user)
     {
         // merge with previous free block
+        Z_Unbin(other);
         other->size += block->size;
         other->next = block->next;
         other->next->prev = other;
@@ -115,6 +286,7 @@ void Z_Free(void *ptr)
     if (!other->user)
     {
         // merge the next free block onto the end
+        Z_Unbin(other);
         block->size += other->size;
         block->next = other->next;
         block->next->prev = block;
@@ -122,14 +294,128 @@ void Z_Free(void *ptr)
         if (other == mainzone->rover)
             mainzone->rover = block;
     }
+
+    Z_Bin(block);
+}
+
+//
+// Z_PurgeLRU
+// Looks for the smallest runs of free and purgable blocks
+//  that can hold size, and purges the one whose newest
+//  block is the oldest. Returns the freed block, or NULL
+//  if every run was used within the reserve.
+//
+memblock_t *Z_PurgeLRU(int size)
+{
+    memblock_t *start;
+    memblock_t *end;
+    memblock_t *block;
+    memblock_t *best;
+    memblock_t *rover;
+    memblock_t *base;
+    int total;
+    int newest;
+    int bestnewest;
+    int oldest;
+    int cutoff;
+
+    cutoff = gametic - zonereserve;
+
+    // nothing purgable is old enough, don't walk the list
+    if (zoneoldest > cutoff)
+        return NULL;
+
+    best = NULL;
+    bestnewest = MAXINT;
+    oldest = MAXINT;
+
+    start = mainzone->blocklist.next;
+    total = 0;
+    newest = -MAXINT;
+
+    for (end = start; end != &mainzone->blocklist; end = end->next)
+    {
+        if (end->user && end->tag >= PU_PURGELEVEL && end->stamp < oldest)
+            oldest = end->stamp;
+
+        if (end->user && (end->tag < PU_PURGELEVEL || end->stamp > cutoff))
+        {
+            // the run ends here
+            start = end->next;
+            total = 0;
+            newest = -MAXINT;
+            continue;
+        }
+
+        total += end->size;
+
+        if (end->user && end->stamp > newest)
+            newest = end->stamp;
+
+        // drop blocks from the front while it still fits
+        while (total - start->size >= size)
+        {
+            total -= start->size;
+
+            if (start->user && start->stamp == newest)
+            {
+                // the newest block was dropped, find the next one
+                newest = -MAXINT;
+
+                for (block = start->next;; block = block->next)
+                {
+                    if (block->user && block->stamp > newest)
+                        newest = block->stamp;
+
+                    if (block == end)
+                        break;
+                }
+            }
+
+            start = start->next;
+        }
+
+        if (total < size)
+            continue;
+
+        if (newest < bestnewest)
+        {
+            bestnewest = newest;
+            best = start;
+        }
+    }
+
+    zoneoldest = oldest == MAXINT ? gametic : oldest;
+
+    if (!best)
+        return NULL;
+
+    // free the run, the same way the rover does
+    if (!best->prev->user)
+        best = best->prev;
+
+    base = rover = best;
+
+    do
+    {
+        if (rover->user)
+        {
+            base = base->prev;
+            Z_Free((byte *)rover + sizeof(memblock_t));
+            base = base->next;
+            rover = base->next;
+        }
+        else
+            rover = rover->next;
+    } while (base->user || base->size < size);
+
+    return base;
 }
 
 //
 // Z_Malloc
 // You can pass a NULL user if the tag is < PU_PURGELEVEL.
 //
-#define MINFRAGMENT sizeof(memblock_t)
-
 void *
 Z_Malloc(int size,
          int tag,
@@ -143,53 +429,67 @@ Z_Malloc(int size,
 
     size = (size + 3) & ~3;
 
-    // scan through the block list,
-    // looking for the first free block
-    // of sufficient size,
-    // throwing out any purgable blocks along the way.
-
     // account for size of block header
     size += sizeof(memblock_t);
 
-    // if there is a free block behind the rover,
-    //  back up over them
-    base = mainzone->rover;
+    // free blocks have to hold their bin links
+    if (size < MINBLOCK)
+        size = MINBLOCK;
 
-    if (!base->prev->user)
-        base = base->prev;
+    base = Z_FindFree(size);
 
-    rover = base;
-    start = base->prev;
+    if (!base)
+        base = Z_PurgeLRU(size);
 
-    do
+    if (!base)
     {
-        if (rover->user)
+        // scan through the block list,
+        // looking for the first free block
+        // of sufficient size,
+        // throwing out any purgable blocks along the way.
+
+        // if there is a free block behind the rover,
+        //  back up over them
+        base = mainzone->rover;
+
+        if (!base->prev->user)
+            base = base->prev;
+
+        rover = base;
+        start = base->prev;
+
+        do
         {
-            if (rover->tag < PU_PURGELEVEL)
+            if (rover->user)
             {
-                // hit a block that can't be purged,
-                //  so move base past it
-                base = rover = rover->next;
+                if (rover->tag < PU_PURGELEVEL)
+                {
+                    // hit a block that can't be purged,
+                    //  so move base past it
+                    base = rover = rover->next;
+                }
+                else
+                {
+                    // free the rover block (adding the size to base)
+
+                    // the rover can be the base block
+                    base = base->prev;
+                    Z_Free((byte *)rover + sizeof(memblock_t));
+                    base = base->next;
+                    rover = base->next;
+                }
             }
             else
-            {
-                // free the rover block (adding the size to base)
+                rover = rover->next;
+        } while (base->user || base->size < size);
+    }
 
-                // the rover can be the base block
-                base = base->prev;
-                Z_Free((byte *)rover + sizeof(memblock_t));
-                base = base->next;
-                rover = base->next;
-            }
-        }
-        else
-            rover = rover->next;
-    } while (base->user || base->size < size);
+    Z_Unbin(base);
 
     // found a block big enough
     extra = base->size - size;
 
-    if (extra > MINFRAGMENT)
+    if (extra >= MINBLOCK)
     {
         // there will be a free fragment after the allocated block
         newblock = (memblock_t *)((byte *)base + size);
@@ -204,6 +504,8 @@ Z_Malloc(int size,
 
         base->next = newblock;
         base->size = size;
+
+        Z_Bin(newblock);
     }
 
     if (user)
@@ -218,6 +520,7 @@ Z_Malloc(int size,
         base->user = (void *)2;
     }
     base->tag = tag;
+    base->stamp = gametic;
 
     // next allocation will start looking here
     mainzone->rover = base->next;
@@ -225,6 +528,33 @@ Z_Malloc(int size,
     return (void *)((byte *)base + sizeof(memblock_t));
 }
 
+//
+// Z_ChangeTag
+//
+void Z_ChangeTag(void *ptr, int tag)
+{
+    memblock_t *block;
+
+    if (!Z_InZone(ptr))
+        return;
+
+    block = (memblock_t *)((byte *)ptr - sizeof(memblock_t));
+    block->tag = tag;
+    block->stamp = gametic;
+}
+
+//
+// Z_ChangeUser
+//
+void Z_ChangeUser(void *ptr, void **user)
+{
+    memblock_t *block;
+
+    block = (memblock_t *)((byte *)ptr - sizeof(memblock_t));
+    block->user = user;
+    *user = ptr;
+}
+
 //
 // Z_FreeTags
 //
@@ -249,3 +579,77 @@ void Z_FreeTags(int lowtag,
             Z_Free((byte *)block + sizeof(memblock_t));
     }
 }
+
+//
+// Z_Compact
+// Slides purgable blocks down over the free space in front
+//  of them, updating their users, so free space gathers
+//  in front of the blocks that can't move and at the end.
+// Other blocks may be pointed to from anywhere and stay.
+// Only call it between levels, while nothing holds on to
+//  a purgable block.
+//
+void Z_Compact(void)
+{
+    memblock_t *block;
+    memblock_t *next;
+    memblock_t *after;
+    memblock_t *prev;
+    int freesize;
+    int start;
+
+    start = ticcount;
+
+    for (block = mainzone->blocklist.next;
+         block != &mainzone->blocklist;
+         block = block->next)
+    {
+        if (block->user)
+            continue;
+
+        // pull the movable blocks behind it down
+        next = block->next;
+
+        while (next->tag >= PU_PURGELEVEL && next->user > (void **)0x100)
+        {
+            Z_Unbin(block);
+
+            freesize = block->size;
+            prev = block->prev;
+            after = next->next;
+
+            memmove(block, next, next->size);
+            block->prev = prev;
+            *block->user = (byte *)block + sizeof(memblock_t);
+            zonemoved += block->size;
+
+            // the free space now follows it
+            next = (memblock_t *)((byte *)block + block->size);
+            next->size = freesize;
+            next->user = NULL;
+            next->tag = 0;
+            next->prev = block;
+            next->next = after;
+            after->prev = next;
+            block->next = next;
+
+            if (!after->user)
+            {
+                // merge the next free block onto the end
+                Z_Unbin(after);
+                next->size += after->size;
+                next->next = after->next;
+                next->next->prev = next;
+            }
+
+            Z_Bin(next);
+
+            block = next;
+            next = block->next;
+        }
+    }
+
+    mainzone->rover = mainzone->blocklist.next;
+
+    zonecompacttics += ticcount - start;
+}
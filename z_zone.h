@@ -42,16 +42,30 @@ void Z_Init(void);
 void *Z_Malloc(int size, int tag, void *ptr);
 void Z_Free(void *ptr);
 void Z_FreeTags(int lowtag, int hightag);
+void Z_ChangeTag(void *ptr, int tag);
+void Z_ChangeUser(void *ptr, void **user);
+void Z_Compact(void);
 
-#define Z_ChangeTag(ptr, tagval) ((memblock_t *)((byte *)ptr - sizeof(memblock_t)))->tag = tagval
+extern int zonemoved;
+extern int zonecompacttics;
+
+// Tics a purgable block is kept after its last use,
+//  as long as older blocks can be purged instead.
+extern int zonereserve;
 
 typedef struct memblock_s
 {
     int size;    // including the header and possibly tiny fragments
     void **user; // NULL if a free block
     int tag;     // purgelevel
+    int stamp;   // gametic of the last use
     struct memblock_s *next;
     struct memblock_s *prev;
 } memblock_t;
 
+// Marks a cached block used this tic, for caches
+//  whose hits don't go through Z_ChangeTag.
+// The caller needs gametic from doomstat.h.
+#define Z_Touch(ptr) (((memblock_t *)((byte *)(ptr) - sizeof(memblock_t)))->stamp = gametic)
+
 #endif